@@ -33,12 +33,12 @@ class blePedal:public effectModule
   float gain;
    
   public:
-  void init();
-  void deInit();
-  void onControlChange(int controlIndex);
-  void onButtonChange(int buttonIndex);
-  void process(float* inLeft, float* inRight, float* outLeft, float* outRight, int sampleCount);
-  void onBleTerminalRequest(const char* request, char* response);
+  void init() override;
+  void deInit() override;
+  void onControlChange(int controlIndex) override;
+  void onButtonChange(int buttonIndex) override;
+  void process(float* inLeft, float* inRight, float* outLeft, float* outRight, int sampleCount) override;
+  void onBleTerminalRequest(const char* request, char* response) override;
 };
 
 ////////////////////////////////////////////////////////////////////////
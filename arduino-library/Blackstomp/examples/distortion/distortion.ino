@@ -24,25 +24,32 @@
  * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
  * THE SOFTWARE.
  */
+//uncomment the following line to measure the processing stages marked by PROFILE_STAGE
+//the result is shown by the system monitor
+//#define BLACKSTOMP_PROFILER
 #include "blackstomp.h"
 
 class distortion:public effectModule
 {
   private:
-    waveShaper dist;
+    waveShaperADAA dist;  //high gain stage, anti-aliased
     waveShaper dist2;
     rcHiPass decoupler;
     rcHiPass decoupler2;
     simpleTone tonecontrol;
+    biquadFilter* midEq;  //peaking eq redesigned at every move of the mid knob
     noiseGate gate;
+    partitionedConvolver cabinet;  //cabinet simulation, on the second button
     float inGain;
     float outGain;
+    smoothedValue smoothInGain;
+    smoothedValue smoothOutGain;
   public:
-  void init();
-  void deInit();
-  void onControlChange(int controlIndex);
-  void onButtonChange(int buttonIndex);
-  void process(float* inLeft, float* inRight, float* outLeft, float* outRight, int sampleCount);
+  void init() override;
+  void deInit() override;
+  void onControlChange(int controlIndex) override;
+  void onButtonChange(int buttonIndex) override;
+  void process(float* inLeft, float* inRight, float* outLeft, float* outRight, int sampleCount) override;
 };
 
 ////////////////////////////////////////////////////////////////////////
@@ -78,6 +85,11 @@ void distortion::init()
   control[2].levelCount = 128; //(0-127)
   control[2].slowSpeed = true;
 
+  control[3].name = "Mid";
+  control[3].mode = CM_POT;
+  control[3].levelCount = 128; //(0-127)
+  control[3].slowSpeed = true;
+
   control[4].name = "Noise Gate";
   control[4].mode = CM_POT;
   control[4].levelCount = 128; //(0-127)
@@ -85,15 +97,15 @@ void distortion::init()
 
   inGain=1;
   outGain=1;
+  smoothInGain.setValue(inGain);
+  smoothOutGain.setValue(outGain);
 
   //DISTORTION
-  //You can customize the distortion element dist and dist2 by modifying the transferFunctionTable member (256 array elements)
+  //You can customize the distortion element dist by loading a transfer function table (or function) over -1 .. 1
+  //and dist2 by modifying the transferFunctionTable member (256 array elements)
   /*
-   * dist.transferFunctionTable[0]=-1;
-   * dist.transferFunctionTable[1]=-0.99;
-   * ..
-   * ..
-   * dist.transferFunctionTable[255]  = 1;
+   * const float curve[] = {-1, -0.99, .., 1};
+   * dist.setTransferFunction(curve, sizeof(curve)/sizeof(float));
    * 
    * dist2.transferFunctionTable[0]=-1;
    * ..
@@ -107,16 +119,38 @@ void distortion::init()
 
   //set up the buttons
   button[0].mode = BM_TOGGLE;
+  button[1].mode = BM_TOGGLE;
+  
+  //MID EQ
+  //designed in onControlChange(), the coefficients ramp to each new design over one block
+  midEq = new biquadFilter(1);
   
-  //do resource allocation (if needed)..
-  //..
+  //CABINET SIMULATION
+  //a 1024-tap IR of a generic closed-back 4x12 response, built from the impulse response of a few filters,
+  //a measured cabinet IR (44.1 kHz, up to 2048 taps) is loaded the same way with cabinet.init()
+  const int irLength = 1024;
+  float* ir = new float[irLength];
+  float coef[25];
+  designBiquad(coef, FT_HIGHPASS, 80, 0.7071f);
+  designBiquad(coef+5, FT_PEAKING, 110, 1.2f, 4);
+  designBiquad(coef+10, FT_PEAKING, 450, 1.0f, -5);
+  designBiquad(coef+15, FT_PEAKING, 2300, 1.5f, 4);
+  designButterworth(coef+20, 1, false, 4800);
+  biquadFilter cabFilter(5);
+  cabFilter.setCoef(coef);
+  //impulse of 0.7 (-3 dB): about the loudness without the cabinet
+  for(int i=0;i<irLength;i++)
+    ir[i] = cabFilter.process((i == 0) ? 0.7f : 0.0f);
+  cabinet.init(ir, irLength);
+  delete[] ir;
 } 
 
 ////////////////////////////////////////////////////////////////////////
 void distortion::deInit()
 {
   //do resource deallocation (if needed)..
-  //..
+  delete midEq;
+  midEq = NULL;
 }
 
 ////////////////////////////////////////////////////////////////////////
@@ -139,6 +173,14 @@ void distortion::onControlChange(int controlIndex)
       tonecontrol.setTone((float)control[2].value/127.0f);
       break;
     }
+    case 3: //mid: -12 .. +12 dB at 750 Hz, interpolated so that a knob sweep doesn't step
+    {
+      float coef[5];
+      float gainDb = 24.0f * (float)control[3].value/127.0f - 12.0f;
+      designBiquad(coef, FT_PEAKING, 750, 0.8f, gainDb);
+      midEq->setCoef(coef, true);
+      break;
+    }
     case 4: //noise gate
     {
       float val = (float)control[4].value/127.0f;
@@ -166,24 +208,58 @@ void distortion::onButtonChange(int buttonIndex)
       }
       break;
     }
+    case 1:
+    {
+      if(button[1].value)
+        auxLed->turnOn();
+      else auxLed->turnOff();
+      break;
+    }
    }
 };
 
 ////////////////////////////////////////////////////////////////////////
 void distortion::process(float* inLeft, float* inRight, float* outLeft, float* outRight, int sampleCount)
 {   
-  for(int i=0;i<sampleCount;i++)
+  //ramp the gains to the latest control values to avoid zipper noise
+  smoothInGain.setTarget(inGain);
+  smoothOutGain.setTarget(outGain);
+
+  //process the whole block stage by stage, each stage in its own scope for the profiler
+  {
+    PROFILE_STAGE("noiseGate", sampleCount);
+    gate.process(inLeft, outLeft, sampleCount);
+  }
+  {
+    PROFILE_STAGE("waveShaper", sampleCount);
+    smoothInGain.applyGain(outLeft, sampleCount);
+    dist.process(outLeft, outLeft, sampleCount);
+  }
+  {
+    PROFILE_STAGE("rcHiPass", sampleCount);
+    decoupler.process(outLeft, outLeft, sampleCount);
+  }
+  {
+    PROFILE_STAGE("waveShaper2", sampleCount);
+    dist2.process(outLeft, outLeft, sampleCount);
+  }
+  {
+    PROFILE_STAGE("rcHiPass2", sampleCount);
+    decoupler2.process(outLeft, outLeft, sampleCount);
+  }
+  {
+    PROFILE_STAGE("simpleTone", sampleCount);
+    tonecontrol.process(outLeft, outLeft, sampleCount);
+  }
+  {
+    PROFILE_STAGE("midEq", sampleCount);
+    midEq->process(outLeft, outLeft, sampleCount);
+    smoothOutGain.applyGain(outLeft, sampleCount);
+  }
+  if(button[1].value)
   {
-    float temp = inLeft[i]; 
-    temp = gate.process(temp);
-    temp = inGain * temp;
-    temp = dist.process(temp);
-    temp = decoupler.process(temp);
-    temp = dist2.process(temp);
-    temp = decoupler2.process(temp);
-    temp = tonecontrol.process(temp);
-    temp = outGain * temp;
-    outLeft[i] = temp;
+    PROFILE_STAGE("cabinet", sampleCount);
+    cabinet.process(outLeft, outLeft, sampleCount);
   }
 }
 
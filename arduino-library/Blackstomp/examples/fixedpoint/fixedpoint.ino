@@ -0,0 +1,269 @@
+/*!
+ *  @file       fixedpoint.ino
+ *  Project     Blackstomp Arduino Library
+ *  @brief      Blackstomp Library for the Arduino
+ *  @author     Hasan Murod
+ *  @date       17/10/2026
+ *  @license    MIT - Copyright (c) 2020 Hasan Murod
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+//integer-native distortion: the module processes the raw i2s frame (PM_RAW) with the Q31 primitives,
+//without any float conversion in the audio path
+//at startup the cpu cycles per sample of the float and the fixed-point primitives are printed on the serial port
+#include "blackstomp.h"
+
+class fixedPointDistortion:public effectModule
+{
+  private:
+    waveShaperQ31 dist;
+    rcHiPassQ31 decoupler;
+    rcLoPassQ31 tone;
+    int32_t inGain;   //16.16 fixed-point
+    int32_t outGain;  //16.16 fixed-point
+  public:
+  void init() override;
+  void onControlChange(int controlIndex) override;
+  void onButtonChange(int buttonIndex) override;
+  void processRaw(int32_t* frame, int sampleCount) override;
+};
+
+////////////////////////////////////////////////////////////////////////
+void fixedPointDistortion::init()
+{ 
+  //select the appropriate device by uncommenting one of the following two lines:
+  //setDeviceType(DT_ESP32_A1S_AC101);
+  setDeviceType(DT_ESP32_A1S_ES8388);
+  
+  //define your effect name
+  name = "FIXED POINT DIST";
+
+  //define the input mode (IM_LR or IM_LMIC)
+  inputMode = IM_LR;
+  
+  //process the i2s frame directly
+  processMode = PM_RAW;
+
+  //set up the controls
+  control[0].name = "Out Level"; 
+  control[0].mode = CM_POT;
+  control[0].levelCount = 128; //(0-127)
+  control[0].slowSpeed = true;
+
+  control[1].name = "Gain"; 
+  control[1].mode = CM_POT;
+  control[1].levelCount = 128; //(0-127)
+  control[1].slowSpeed = true;
+
+  control[2].name = "Tone";
+  control[2].mode = CM_POT;
+  control[2].levelCount = 128; //(0-127)
+  control[2].slowSpeed = true;
+
+  inGain = 65536;
+  outGain = 65536;
+  decoupler.setCutOff(20);
+  tone.setCutOff(2000);
+
+  //set up the buttons
+  button[0].mode = BM_TOGGLE;
+} 
+
+////////////////////////////////////////////////////////////////////////
+void fixedPointDistortion::onControlChange(int controlIndex)
+{
+  switch(controlIndex)
+  {
+    case 0: //out level
+    {
+      outGain = 65536.0f * powf((float)control[0].value/127.0f,2);
+      break;
+    }
+    case 1: //gain
+    {
+      inGain = 65536.0f * (1.0f + 49.0f * (float)control[1].value/127.0f);
+      break;
+    }
+    case 2: //tone, 500 Hz to 8 KHz
+    {
+      tone.setCutOff(500.0f * powf(16.0f, (float)control[2].value/127.0f));
+      break;
+    }
+  }
+}
+
+void fixedPointDistortion::onButtonChange(int buttonIndex)
+{
+   switch(buttonIndex)
+   {
+    case 0:
+    {
+      if(button[0].value)
+      {
+        analogBypass(false);
+        mainLed->turnOn();
+      }
+      else
+      {
+        analogBypass(true);
+        mainLed->turnOff();
+      }
+      break;
+    }
+   }
+};
+
+////////////////////////////////////////////////////////////////////////
+void fixedPointDistortion::processRaw(int32_t* frame, int sampleCount)
+{
+  //the left channel is processed (stride 2 over the interleaved frame) and copied to the right
+  for(int i=0;i<2*sampleCount;i+=2)
+    frame[i] = q31Scale(frame[i], inGain);
+  dist.process(frame, frame, sampleCount, 2);
+  decoupler.process(frame, frame, sampleCount, 2);
+  tone.process(frame, frame, sampleCount, 2);
+  for(int i=0;i<2*sampleCount;i+=2)
+  {
+    frame[i] = q31Scale(frame[i], outGain);
+    frame[i+1] = frame[i];
+  }
+}
+
+////////////////////////////////////////////////////////////////////////
+//BENCHMARK: cycles per sample of the float and the Q31 primitives
+#define BENCH_SAMPLES 256
+
+//biquad kernel of the library build (see bsdsp.cpp), rebuild with BLACKSTOMP_PORTABLE_BIQUAD to measure the other one
+#define BENCH_BIQUAD_KERNEL "portable"
+#if defined(ARDUINO_ARCH_ESP32) && defined(__has_include) && !defined(BLACKSTOMP_PORTABLE_BIQUAD)
+#if __has_include(<dsps_biquad.h>)
+#undef BENCH_BIQUAD_KERNEL
+#define BENCH_BIQUAD_KERNEL "ESP-DSP"
+#endif
+#endif
+
+static float benchCycles(unsigned int start, unsigned int end)
+{
+  return (float)(end - start)/(float)BENCH_SAMPLES;
+}
+
+void runBenchmark()
+{
+  static float fin[BENCH_SAMPLES];
+  static float fout[BENCH_SAMPLES];
+  static q31_t qin[BENCH_SAMPLES];
+  static q31_t qout[BENCH_SAMPLES];
+  for(int i=0;i<BENCH_SAMPLES;i++)
+  {
+    fin[i] = 0.8f * sinf(6.283f * (float)i / 64.0f);
+    qin[i] = floatToQ31(fin[i]);
+  }
+  
+  //4th order 20Hz low-pass (the noise gate's envelope filter)
+  const float co[] = 
+  {
+    0.000002152381733479521, 0.000004304763466959042, 0.000002152381733479521, 1.9947405124091158, -0.9947486108316238,
+    0.0000019073486328125, 0.000003814697265625, 0.0000019073486328125, 1.997813341671618, -0.9978214525694677
+  };
+  rcLoPass flp;
+  rcLoPassQ31 qlp;
+  rcHiPass fhp;
+  rcHiPassQ31 qhp;
+  waveShaper fws;
+  waveShaperQ31 qws;
+  fractionalDelay fdl;
+  delayLineQ15 qdl;
+  fdl.init(10);
+  qdl.init(441);
+  
+  Serial.printf("\nCYCLES PER SAMPLE (float / Q31):\n");
+  unsigned int t0, t1, t2;
+  
+  //biquad cascades of 1 to 8 stages (the two stages of the envelope filter repeated)
+  float cascade[40];
+  for(int i=0;i<40;i++)
+    cascade[i] = co[i % 10];
+  for(int stages=1;stages<=8;stages++)
+  {
+    biquadFilter fbq(stages);
+    biquadFilterQ31 qbq(stages);
+    fbq.setCoef(cascade);
+    qbq.setCoef(cascade);
+    t0 = xthal_get_ccount();
+    fbq.process(fin, fout, BENCH_SAMPLES);
+    t1 = xthal_get_ccount();
+    qbq.process(qin, qout, BENCH_SAMPLES);
+    t2 = xthal_get_ccount();
+    Serial.printf("biquad (%s), %d stages: %.1f / %.1f\n", BENCH_BIQUAD_KERNEL, stages, benchCycles(t0,t1), benchCycles(t1,t2));
+  }
+  
+  t0 = xthal_get_ccount();
+  flp.process(fin, fout, BENCH_SAMPLES);
+  t1 = xthal_get_ccount();
+  qlp.process(qin, qout, BENCH_SAMPLES);
+  t2 = xthal_get_ccount();
+  Serial.printf("rc low-pass: %.1f / %.1f\n", benchCycles(t0,t1), benchCycles(t1,t2));
+  
+  t0 = xthal_get_ccount();
+  fhp.process(fin, fout, BENCH_SAMPLES);
+  t1 = xthal_get_ccount();
+  qhp.process(qin, qout, BENCH_SAMPLES);
+  t2 = xthal_get_ccount();
+  Serial.printf("rc high-pass: %.1f / %.1f\n", benchCycles(t0,t1), benchCycles(t1,t2));
+  
+  t0 = xthal_get_ccount();
+  fws.process(fin, fout, BENCH_SAMPLES);
+  t1 = xthal_get_ccount();
+  qws.process(qin, qout, BENCH_SAMPLES);
+  t2 = xthal_get_ccount();
+  Serial.printf("waveshaper: %.1f / %.1f\n", benchCycles(t0,t1), benchCycles(t1,t2));
+  
+  t0 = xthal_get_ccount();
+  for(int i=0;i<BENCH_SAMPLES;i++)
+  {
+    fdl.write(fin[i]);
+    fout[i] = fdl.read(5.3f);
+  }
+  t1 = xthal_get_ccount();
+  for(int i=0;i<BENCH_SAMPLES;i++)
+  {
+    qdl.write(qin[i]);
+    qout[i] = qdl.read(233 << 16 | 0x4CCC, true);
+  }
+  t2 = xthal_get_ccount();
+  Serial.printf("delay write + interpolated read: %.1f / %.1f\n", benchCycles(t0,t1), benchCycles(t1,t2));
+}
+
+//declare an instance of your effect module
+fixedPointDistortion  myPedal;
+
+//setup the effect modules by calling blackstompSetup() inside arduino core's setup()
+void setup() {
+  Serial.begin(115200);
+  runBenchmark();
+  
+  //SETTING UP THE EFFECT MODULE
+  blackstompSetup(&myPedal);
+}
+
+//let the main loop empty to dedicate the core 1 for the main audio task
+void loop() {
+ 
+}
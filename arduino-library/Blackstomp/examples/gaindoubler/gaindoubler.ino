@@ -8,11 +8,11 @@ class gainDoubler:public effectModule
   float gainRange; 
   
   public:
-  void init();
-  void deInit();
-  void onButtonChange(int buttonIndex);
-  void onControlChange(int controlIndex);
-  void process(float* inLeft, float* inRight, float* outLeft, float* outRight, int sampleCount);
+  void init() override;
+  void deInit() override;
+  void onButtonChange(int buttonIndex) override;
+  void onControlChange(int controlIndex) override;
+  void processInterleaved(float* frame, int sampleCount) override;
 };
 
 //effect module class implementation
@@ -31,6 +31,9 @@ void gainDoubler::init()
  
   //define the input mode (IM_LR or IM_LMIC) 
   inputMode = IM_LR;
+  
+  //process the interleaved frame in place (see processInterleaved() below)
+  processMode = PM_INTERLEAVED;
  
   //setting up the buttons
   //setup the first button as toggle button
@@ -129,13 +132,11 @@ void gainDoubler::onControlChange(int controlIndex)
   }
 }
 
-void gainDoubler::process(float* inLeft, float* inRight, float* outLeft, float* outRight, int sampleCount)
+void gainDoubler::processInterleaved(float* frame, int sampleCount)
 {
-  for(int i=0;i<sampleCount;i++)
-  {
-    outLeft[i] = gain * gainRange * inLeft[i];
-    outRight[i] = gain * gainRange * inRight[i];
-  }
+  float g = gain * gainRange;
+  for(int i=0;i<2*sampleCount;i++)
+    frame[i] = g * frame[i];
 }
 
 //Arduino core setup
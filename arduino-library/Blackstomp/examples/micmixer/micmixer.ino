@@ -31,12 +31,13 @@ class micMixer:public effectModule
 {
   private:
   float micLevel;
+  compressor ducker;  //the mic ducks the line input (talk-over)
   public:
-  void init();
-  void deInit();
-  void onControlChange(int controlIndex);
-  void onButtonChange(int buttonIndex);
-  void process(float* inLeft, float* inRight, float* outLeft, float* outRight, int sampleCount);
+  void init() override;
+  void deInit() override;
+  void onControlChange(int controlIndex) override;
+  void onButtonChange(int buttonIndex) override;
+  void process(float* inLeft, float* inRight, float* outLeft, float* outRight, int sampleCount) override;
 };
 
 ////////////////////////////////////////////////////////////////////////
@@ -68,6 +69,12 @@ void micMixer::init()
   control[2].levelCount = 128; 
   control[2].value = 64;
   control[2].slowSpeed = true;
+
+  control[3].name = "Ducking"; 
+  control[3].mode = CM_POT;
+  control[3].levelCount = 128; 
+  control[3].value = 0;
+  control[3].slowSpeed = true;
   
   //setup the buttons
   //main button
@@ -75,6 +82,11 @@ void micMixer::init()
 
   //other initialization
   micLevel = 1;
+  ducker.setThreshold(-40);
+  ducker.setRatio(1);
+  ducker.setKnee(12);
+  ducker.setAttack(10);
+  ducker.setRelease(400);
 } 
 
 ////////////////////////////////////////////////////////////////////////
@@ -103,6 +115,11 @@ void micMixer::onControlChange(int controlIndex)
       micLevel = 4*(float)control[2].value/127.0;
       break;
     }
+    case 3: //ducking: compression ratio of the line input above the mic threshold, 1 (off) to 10
+    {
+      ducker.setRatio(1 + 9*(float)control[3].value/127.0);
+      break;
+    }
   }
 }
 
@@ -128,11 +145,13 @@ void micMixer::onButtonChange(int buttonIndex)
 ////////////////////////////////////////////////////////////////////////
 void micMixer::process(float* inLeft, float* inRight, float* outLeft, float* outRight, int sampleCount)
 {   
+  if(button[0].value) //duck the line input with the mic as the sidechain
+    ducker.process(inLeft, outLeft, sampleCount, inRight);
   for(int i=0;i<sampleCount;i++)
   {
     if(button[0].value) //effect is activated
     {
-      outLeft[i] = inLeft[i]+micLevel*inRight[i];
+      outLeft[i] = outLeft[i]+micLevel*inRight[i];
       outRight[i] = outLeft[i];
     }
     else //effect is deactivated, software-bypassed
@@ -37,11 +37,11 @@ class midiPedal:public effectModule
 {  
   public:
   float gain;
-  void init();
-  void deInit();
-  void onControlChange(int controlIndex);
-  void onButtonChange(int buttonIndex);
-  void process(float* inLeft, float* inRight, float* outLeft, float* outRight, int sampleCount);
+  void init() override;
+  void deInit() override;
+  void onControlChange(int controlIndex) override;
+  void onButtonChange(int buttonIndex) override;
+  void process(float* inLeft, float* inRight, float* outLeft, float* outRight, int sampleCount) override;
 };
 
 ////////////////////////////////////////////////////////////////////////
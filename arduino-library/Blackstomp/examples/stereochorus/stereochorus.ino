@@ -30,6 +30,7 @@ class stereoChorus:public effectModule
 {
   private:
   float depth;
+  smoothedValue smoothDepth;
   float freq;
   float beatFrequency;
   float phaseDiff;
@@ -37,13 +38,15 @@ class stereoChorus:public effectModule
   fractionalDelay delay2;
   oscillator lfo1;
   oscillator lfo2;
+  float wet1[MAX_AUDIO_BLOCK]; //modulation (delay in samples), then the delayed signal
+  float wet2[MAX_AUDIO_BLOCK];
    
   public:
-  void init();
-  void deInit();
-  void onControlChange(int controlIndex);
-  void onButtonChange(int buttonIndex);
-  void process(float* inLeft, float* inRight, float* outLeft, float* outRight, int sampleCount);
+  void init() override;
+  void deInit() override;
+  void onControlChange(int controlIndex) override;
+  void onButtonChange(int buttonIndex) override;
+  void process(float* inLeft, float* inRight, float* outLeft, float* outRight, int sampleCount) override;
 };
 
 ////////////////////////////////////////////////////////////////////////
@@ -94,6 +97,7 @@ void stereoChorus::init()
   delay2.init(3); //init for 3 ms delay
   freq=5;
   depth = 0.5;
+  smoothDepth.setValue(depth);
   beatFrequency = 2.5;
   lfo1.setFrequency(freq);
   lfo2.setFrequency(freq+beatFrequency);
@@ -167,25 +171,36 @@ void stereoChorus::onButtonChange(int buttonIndex)
 ////////////////////////////////////////////////////////////////////////
 void stereoChorus::process(float* inLeft, float* inRight, float* outLeft, float* outRight, int sampleCount)
 {   
+  //ramp the depth to the latest control value to avoid zipper noise
+  smoothDepth.setTarget(depth);
+
+  //write the whole block, then compute the modulated delays in samples
+  delay1.write(inLeft, sampleCount);
+  delay2.write(inRight, sampleCount); //write anyway, no matter it's sereo or mono input
+  float samplesPerMs = delay1.getSampleCountPerMs();
   for(int i=0;i<sampleCount;i++)
   {
-    delay1.write(inLeft[i]);
-    delay2.write(inRight[i]); //write anyway, no matter it's sereo or mono input
-      
+    float d = smoothDepth.next() * samplesPerMs;
     lfo1.update();
     lfo2.update();
-    float dt1 = (1 + lfo1.getOutput())*depth;
-    float dt2;
+    wet1[i] = (1 + lfo1.getOutput())*d;
     if(control[5].value==0) //asynchronous
-      dt2 = (1 + lfo2.getOutput())*depth;
+      wet2[i] = (1 + lfo2.getOutput())*d;
     else  //synchronous
-      dt2 = (1 + lfo1.getOutput((float)control[4].value))*depth;
+      wet2[i] = (1 + lfo1.getOutput((float)control[4].value))*d;
+  }
 
-    outLeft[i]=0.7*inLeft[i] + 0.7*delay1.read(dt1);
-    if(control[3].value) //if stereo input
-      outRight[i] = 0.7*inRight[i] + 0.7*delay2.read(dt2);
-    else //if mono
-      outRight[i]=0.7*inLeft[i] + 0.7*delay1.read(dt2);
+  //read the delayed blocks in place of the modulation
+  delay1.read(wet1, sampleCount, 0, wet1);
+  if(control[3].value) //if stereo input
+    delay2.read(wet2, sampleCount, 0, wet2);
+  else //if mono
+    delay1.read(wet2, sampleCount, 0, wet2);
+  
+  for(int i=0;i<sampleCount;i++)
+  {
+    outLeft[i]=0.7*inLeft[i] + 0.7*wet1[i];
+    outRight[i]=0.7*(control[3].value ? inRight[i] : inLeft[i]) + 0.7*wet2[i];
   }
 }
 
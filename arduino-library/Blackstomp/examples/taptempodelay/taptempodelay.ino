@@ -27,6 +27,17 @@
 
 #include <blackstomp.h>
 
+//parameters written by the control callbacks and read by process()
+struct delayParameters
+{
+  int indexShift;
+  float dryGain;
+  float wetGain;
+  float feedbackGain;
+  bool monoInput;
+  bool stereoOutput;
+};
+
 class taptempoDelay:public effectModule
 {
   private:
@@ -34,21 +45,20 @@ class taptempoDelay:public effectModule
   float* delayBufferR;
   int readIndex;
   int writeIndex;
-  int indexShift;
   int filteredIndexShift;
-  void setTime(int ms);
-  void updateIndex();
-  float dryGain;
-  float wetGain;
-  float feedbackGain;
+  void setTime(delayParameters& p, int ms);
+  void updateIndex(int indexShift);
   float tempoDiv;
+  parameterBlock<delayParameters> params;
+  smoothedValue smoothDryGain;
+  smoothedValue smoothWetGain;
   
   public:
-  void init();
-  void deInit();
-  void onControlChange(int controlIndex);
-  void onButtonChange(int buttonIndex);
-  void process(float* inLeft, float* inRight, float* outLeft, float* outRight, int sampleCount);
+  void init() override;
+  void deInit() override;
+  void onControlChange(int controlIndex) override;
+  void onButtonChange(int buttonIndex) override;
+  void process(float* inLeft, float* inRight, float* outLeft, float* outRight, int sampleCount) override;
 };
 
 ////////////////////////////////////////////////////////////////////////
@@ -128,12 +138,21 @@ void taptempoDelay::init()
   //initialization
   writeIndex = 0;
   readIndex = 0;
-  setTime(500);
   auxLed->blink(10,490,1,0,0);
-  feedbackGain = 0.5;
-  dryGain = 1;
-  wetGain = 1;
+  delayParameters& p = params.lock();
+  setTime(p, 500);
+  p.feedbackGain = 0.5;
+  p.dryGain = 1;
+  p.wetGain = 1;
+  p.monoInput = (control[4].value == 0);
+  p.stereoOutput = (control[3].value == 1);
+  params.commit();
+  smoothDryGain.setValue(1);
+  smoothWetGain.setValue(1);
   tempoDiv = 1;
+  
+  //let the audio task take the committed parameters at every block boundary
+  parameters = &params;
 } 
 
 ////////////////////////////////////////////////////////////////////////
@@ -150,24 +169,42 @@ void taptempoDelay::onControlChange(int controlIndex)
   {
     case 0: //dry wet balance
     {
-      dryGain =  2*(127.0-(float)control[0].value)/127;
+      float dryGain =  2*(127.0-(float)control[0].value)/127;
       if(dryGain>1) dryGain=1;
-      wetGain = 2*(float)control[0].value/127;
+      float wetGain = 2*(float)control[0].value/127;
       if(wetGain>1) wetGain=1;
+      delayParameters& p = params.lock();
+      p.dryGain = dryGain;
+      p.wetGain = wetGain;
+      params.commit();
       break;
     }
     case 1: //repeat
     {
-      feedbackGain = (float)control[1].value /127.0;
+      params.lock().feedbackGain = (float)control[1].value /127.0;
+      params.commit();
       break;
     }
     case 2: //time
     {
       int dt = (control[2].value +1)*10;
-      setTime(dt); 
+      setTime(params.lock(), dt); 
+      params.commit();
       auxLed->blinkUpdate(10,dt-10,1,0,0);
       break;
     }
+    case 3: //output mode
+    {
+      params.lock().stereoOutput = (control[3].value == 1);
+      params.commit();
+      break;
+    }
+    case 4: //input mode
+    {
+      params.lock().monoInput = (control[4].value == 0);
+      params.commit();
+      break;
+    }
     case 5: //tap multiply
     {
       if(control[5].value == 0)
@@ -201,7 +238,8 @@ void taptempoDelay::onButtonChange(int buttonIndex)
     {
       int t = round((float)button[1].value/tempoDiv);
       if(t<10) t=10;
-      setTime(t);
+      setTime(params.lock(), t);
+      params.commit();
       auxLed->blink(10,t-10,1,0,0);
       break;
     }
@@ -209,15 +247,17 @@ void taptempoDelay::onButtonChange(int buttonIndex)
 };
   
 ////////////////////////////////////////////////////////////////////////
-void taptempoDelay::setTime(int ms)
+//set the delay time in the locked parameter set (to be committed by the caller)
+void taptempoDelay::setTime(delayParameters& p, int ms)
 {
-  indexShift = (SAMPLE_RATE * ms)/1000;
+  int indexShift = (SAMPLE_RATE * ms)/1000;
   if(indexShift >= BUFFER_LENGTH)
     indexShift = BUFFER_LENGTH -1;
+  p.indexShift = indexShift;
 }
   
 ////////////////////////////////////////////////////////////////////////
-void taptempoDelay::updateIndex()
+void taptempoDelay::updateIndex(int indexShift)
 {
   //compute the write index
   writeIndex++;
@@ -244,19 +284,28 @@ void taptempoDelay::updateIndex()
 ////////////////////////////////////////////////////////////////////////
 void taptempoDelay::process(float* inLeft, float* inRight, float* outLeft, float* outRight, int sampleCount)
 {   
+  //consistent parameter set for the whole block
+  const delayParameters& p = params.get();
+  
+  //ramp the mix gains to avoid zipper noise
+  smoothDryGain.setTarget(p.dryGain);
+  smoothWetGain.setTarget(p.wetGain);
+  
   for(int i=0;i<sampleCount;i++)
   {
-    updateIndex();
+    updateIndex(p.indexShift);
+    float dryGain = smoothDryGain.next();
+    float wetGain = smoothWetGain.next();
 
     float outL;
     float outR;
 
-    if(control[4].value==0) //mono input
+    if(p.monoInput) //mono input
     {
       inRight[i] = inLeft[i];
     }
 
-    if(control[3].value==1) //stereo output
+    if(p.stereoOutput) //stereo output
     {
       outL = dryGain * inLeft[i] + wetGain * delayBufferL[readIndex];
       outR = dryGain * inRight[i] + wetGain * delayBufferR[readIndex];
@@ -268,12 +317,12 @@ void taptempoDelay::process(float* inLeft, float* inRight, float* outLeft, float
       outR = outL;  //just copy the identical left output to the right output
     }
 
-    delayBufferL[writeIndex] = feedbackGain * delayBufferR[readIndex] + inLeft[i];;
-    if(control[4].value==0 && control[3].value==1)  //if mono input and stereo output
-      delayBufferR[writeIndex] = feedbackGain * delayBufferL[readIndex];
+    delayBufferL[writeIndex] = p.feedbackGain * delayBufferR[readIndex] + inLeft[i];;
+    if(p.monoInput && p.stereoOutput)  //if mono input and stereo output
+      delayBufferR[writeIndex] = p.feedbackGain * delayBufferL[readIndex];
     else 
       //stereo input or mono output
-      delayBufferR[writeIndex] = feedbackGain * delayBufferL[readIndex] + inRight[i];
+      delayBufferR[writeIndex] = p.feedbackGain * delayBufferL[readIndex] + inRight[i];
  
     outLeft[i]=outL;
     outRight[i]=outR; 
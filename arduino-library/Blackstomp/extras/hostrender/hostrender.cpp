@@ -0,0 +1,234 @@
+//Blackstomp host offline renderer
+//streams a wav file through an example effect module in SAMPLECOUNT-sized frames,
+//the same way i2s_task() does on the device, writes the output wav and reports the throughput
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include "hostsystem.h"
+#include "wavfile.h"
+
+//every example sketch is compiled with its setup() renamed to <example>_setup() (see Makefile)
+#define HOST_EXAMPLES(X) \
+  X(blepedal) \
+  X(distortion) \
+  X(fixedpoint) \
+  X(gaindoubler) \
+  X(micmixer) \
+  X(stereochorus) \
+  X(taptempodelay)
+
+#define DECLARE_EXAMPLE(n) void n##_setup();
+HOST_EXAMPLES(DECLARE_EXAMPLE)
+
+struct hostExample
+{
+  const char* name;
+  void (*setup)();
+};
+
+#define LIST_EXAMPLE(n) {#n, n##_setup},
+static const hostExample examples[] = {HOST_EXAMPLES(LIST_EXAMPLE)};
+static const int exampleCount = sizeof(examples)/sizeof(examples[0]);
+
+static void usage()
+{
+  printf("usage: hostrender <example> [options] <in.wav> <out.wav>\n");
+  printf("options:\n");
+  printf("  -c <index>=<value>  set control value (index 0-5)\n");
+  printf("  -b <index>=<value>  set button value (index 0-3), e.g. -b 0=1 to engage the effect\n");
+  printf("  -n <samples>        audio block size, samples per channel (default 32)\n");
+  printf("  -t <ms>             render an extra tail of silence after the input (default 0)\n");
+  printf("  -bits <16|24|32>    output bit depth (default 24)\n");
+  printf("  -q                  don't print the report\n");
+  printf("mono input files feed the left input, the right input stays silent\n");
+  printf("examples:");
+  for(int i=0;i<exampleCount;i++)
+    printf(" %s", examples[i].name);
+  printf("\n");
+}
+
+static bool parseAssignment(const char* arg, int maxIndex, int* index, int* value)
+{
+  if(sscanf(arg, "%d=%d", index, value) != 2)
+    return false;
+  return (*index >= 0) && (*index <= maxIndex);
+}
+
+//saturating mix of the digital output and the analog input (bypass routing), 24-bit range
+static int32_t mixOutput(int32_t digital, int32_t analog)
+{
+  int64_t val = (int64_t)(digital >> 8) + (int64_t)(analog >> 8);
+  if(val > 8388607) val = 8388607;
+  if(val < -8388607) val = -8388607;
+  return (int32_t)val * 256;
+}
+
+int main(int argc, char** argv)
+{
+  if(argc < 2)
+  {
+    usage();
+    return 1;
+  }
+
+  const hostExample* example = NULL;
+  for(int i=0;i<exampleCount;i++)
+  {
+    if(!strcmp(argv[1], examples[i].name))
+      example = &examples[i];
+  }
+  if(example == NULL)
+  {
+    fprintf(stderr, "unknown example: %s\n", argv[1]);
+    usage();
+    return 1;
+  }
+
+  int controlValue[6];
+  bool controlSet[6] = {false};
+  int buttonValue[4];
+  bool buttonSet[4] = {false};
+  int blockSize = 32;
+  float tailMs = 0;
+  int bits = 24;
+  bool quiet = false;
+  const char* inPath = NULL;
+  const char* outPath = NULL;
+
+  for(int i=2;i<argc;i++)
+  {
+    int index, value;
+    if(!strcmp(argv[i], "-c") && i+1 < argc && parseAssignment(argv[i+1], 5, &index, &value))
+    {
+      controlValue[index] = value;
+      controlSet[index] = true;
+      i++;
+    }
+    else if(!strcmp(argv[i], "-b") && i+1 < argc && parseAssignment(argv[i+1], 3, &index, &value))
+    {
+      buttonValue[index] = value;
+      buttonSet[index] = true;
+      i++;
+    }
+    else if(!strcmp(argv[i], "-n") && i+1 < argc)
+      blockSize = atoi(argv[++i]);
+    else if(!strcmp(argv[i], "-t") && i+1 < argc)
+      tailMs = atof(argv[++i]);
+    else if(!strcmp(argv[i], "-bits") && i+1 < argc)
+      bits = atoi(argv[++i]);
+    else if(!strcmp(argv[i], "-q"))
+      quiet = true;
+    else if(argv[i][0] != '-' && inPath == NULL)
+      inPath = argv[i];
+    else if(argv[i][0] != '-' && outPath == NULL)
+      outPath = argv[i];
+    else
+    {
+      fprintf(stderr, "invalid argument: %s\n", argv[i]);
+      usage();
+      return 1;
+    }
+  }
+  if(inPath == NULL || outPath == NULL || (bits != 16 && bits != 24 && bits != 32))
+  {
+    usage();
+    return 1;
+  }
+
+  wavData in;
+  if(!wavRead(inPath, in))
+  {
+    fprintf(stderr, "unable to read %s (16/24/32-bit PCM or 32-bit float wav expected)\n", inPath);
+    return 1;
+  }
+  if(in.sampleRate != SAMPLE_RATE)
+    fprintf(stderr, "warning: %s is %d Hz, the effect runs at %d Hz\n", inPath, in.sampleRate, SAMPLE_RATE);
+
+  if(!setAudioBlock(blockSize))
+  {
+    fprintf(stderr, "invalid block size %d (%d-%d)\n", blockSize, MIN_AUDIO_BLOCK, MAX_AUDIO_BLOCK);
+    return 1;
+  }
+
+  //the sketch's setup() calls blackstompSetup(), which registers and initializes the module
+  example->setup();
+  effectModule* module = hostModule;
+
+  //restore the control and button values, then call the callbacks as eepromsetup_task() does
+  for(int i=0;i<6;i++)
+  {
+    if(controlSet[i])
+      module->control[i].value = controlValue[i];
+    if(module->control[i].mode != CM_DISABLED)
+      module->onControlChange(i);
+  }
+  for(int i=0;i<4;i++)
+  {
+    if(buttonSet[i])
+      module->button[i].value = buttonValue[i];
+    if((module->button[i].mode == BM_TOGGLE) || (buttonSet[i] && module->button[i].mode != BM_DISABLED))
+      module->onButtonChange(i);
+  }
+
+  int sampleCount = hostFrame.getSampleCount();
+  int tailSamples = (int)(tailMs * SAMPLE_RATE / 1000);
+  int totalSamples = in.frameCount + tailSamples;
+  int frameCount = (totalSamples + sampleCount - 1) / sampleCount;
+
+  //interleaved stereo i2s frames, zero padded to whole frames
+  std::vector<int32_t> inbuffer(2 * frameCount * sampleCount, 0);
+  std::vector<int32_t> outbuffer(2 * frameCount * sampleCount, 0);
+  for(int k=0;k<in.frameCount;k++)
+  {
+    inbuffer[2*k] = in.samples[k * in.channelCount];
+    if(in.channelCount > 1)
+      inbuffer[2*k+1] = in.samples[k * in.channelCount + 1];
+  }
+
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  for(int f=0;f<frameCount;f++)
+  {
+    hostFrame.process(&inbuffer[2*f*sampleCount], &outbuffer[2*f*sampleCount]);
+    hostRenderedSamples += sampleCount;
+    
+    //analog routing of the codec
+    for(int i=2*f*sampleCount;i<2*(f+1)*sampleCount;i++)
+    {
+      int ch = i & 1;
+      if(!hostAcodec.dacOut[ch])
+        outbuffer[i] = 0;
+      if(hostAcodec.analogIn[ch])
+        outbuffer[i] = mixOutput(outbuffer[i], inbuffer[i]);
+    }
+  }
+  double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  wavData out;
+  out.sampleRate = in.sampleRate;
+  out.channelCount = 2;
+  out.frameCount = totalSamples;
+  out.samples.assign(outbuffer.begin(), outbuffer.begin() + 2*totalSamples);
+  if(!wavWrite(outPath, out, bits))
+  {
+    fprintf(stderr, "unable to write %s\n", outPath);
+    return 1;
+  }
+
+  if(!quiet)
+  {
+    double rendered = (double)frameCount * sampleCount;
+    double rate = seconds > 0 ? rendered/seconds : 0;
+    printf("%s: %s -> %s\n", example->name, inPath, outPath);
+    printf("block: %d samples, %d dma buffers, latency on the device: %.2f ms\n", getAudioBlock(), getDmaBufferCount(), getAudioLatency());
+    printf("%d frames of %d samples, %.3f s audio rendered in %.3f s\n", frameCount, sampleCount, rendered/SAMPLE_RATE, seconds);
+    printf("throughput: %.0f samples/s per channel (%.1fx real time)\n", rate, rate/SAMPLE_RATE);
+    if(getProfileStageCount() > 0)
+    {
+      char report[PROFILE_MAXSTAGES*64];
+      getProfileReport(report, sizeof(report));
+      printf("stage profile (host ticks are nanoseconds):\n%s", report);
+    }
+  }
+  return 0;
+}
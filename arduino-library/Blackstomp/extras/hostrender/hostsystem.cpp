@@ -0,0 +1,247 @@
+#include "hostsystem.h"
+
+effectModule* hostModule = NULL;
+hostCodec hostAcodec;
+frameProcessor hostFrame;
+unsigned long hostRenderedSamples = 0;
+static DEVICE_TYPE hostDeviceType = DT_ESP32_A1S_AC101;
+static int hostSampleCount = 32;
+static int hostDmaBufferCount = 2;
+static bool hostAudioIsRunning = false;
+
+//######################################################################
+// ARDUINO CORE
+unsigned long millis()
+{
+  return (unsigned long)((hostRenderedSamples * 1000ULL) / SAMPLE_RATE);
+}
+
+void delay(unsigned long ms)
+{
+}
+
+HardwareSerial Serial;
+int HardwareSerial::printf(const char* format, ...)
+{
+  va_list args;
+  va_start(args, format);
+  int n = vfprintf(stderr, format, args);
+  va_end(args);
+  return n;
+}
+
+//######################################################################
+// LED INDICATOR (no led on the host)
+void ledIndicator::turnOn(){}
+void ledIndicator::turnOff(){}
+void ledIndicator::blink(int onPeriod, int offPeriod,int blinkCount,int repeatCount,int restPeriod){}
+void ledIndicator::blinkUpdate(int onPeriod, int offPeriod,int blinkCount,int repeatCount,int restPeriod){}
+void ledIndicator::saveState(){}
+void ledIndicator::restoreState(){}
+void ledIndicator::init(int pin, int priority){missedCount = 0;}
+void ledIndicator::deInit(){}
+
+static ledIndicator _mainLed;
+static ledIndicator _auxLed;
+
+//######################################################################
+// CODEC EMULATION
+hostCodec::hostCodec()
+{
+  outCorrectionGain = 1;
+  muteLeftAdcIn = NULL;
+  muteRightAdcIn = NULL;
+  outVol = 0;
+  inGain = 0;
+  micGain = 0;
+  micNoiseGate = 0;
+  for(int i=0;i<2;i++)
+  {
+    dacOut[i] = true;
+    analogIn[i] = false;
+  }
+}
+
+bool hostCodec::init(int address)
+{
+  i2cAddress = address;
+  return true;
+}
+
+bool hostCodec::analogBypass(bool bypass, BYPASS_MODE bm)
+{
+  if((bm==BM_LR)||(bm==BM_L))
+  {
+    *muteLeftAdcIn = bypass;
+    dacOut[0] = !bypass;
+    analogIn[0] = bypass;
+  }
+  if((bm==BM_LR)||(bm==BM_R))
+  {
+    *muteRightAdcIn = bypass;
+    dacOut[1] = !bypass;
+    analogIn[1] = bypass;
+  }
+  return true;
+}
+
+bool hostCodec::analogSoftBypass(bool bypass, BYPASS_MODE bm)
+{
+  if((bm==BM_LR)||(bm==BM_L))
+  {
+    *muteLeftAdcIn = bypass;
+    dacOut[0] = true;
+    analogIn[0] = bypass;
+  }
+  if((bm==BM_LR)||(bm==BM_R))
+  {
+    *muteRightAdcIn = bypass;
+    dacOut[1] = true;
+    analogIn[1] = bypass;
+  }
+  return true;
+}
+
+//######################################################################
+// PIPELINED MODE
+//the core-0 stage runs synchronously right after its frame is queued,
+//the one block latency between the stages is the same as on the device
+static void hostStage0()
+{
+  while(hostFrame.processStage0());
+}
+
+//######################################################################
+// BLACKSTOMP SYSTEM API
+void blackstompSetup(effectModule* module)
+{
+  _mainLed.init(0, 0);
+  _auxLed.init(0, 0);
+  
+  hostModule = module;
+  hostModule->auxLed = &_auxLed;
+  hostModule->mainLed = &_mainLed;
+  hostModule->init();
+  
+  //validate the port setting (as in blackstomp.cpp)
+  for(int i=0;i<6;i++)
+  {
+    switch(hostModule->control[i].mode)
+    {
+      case CM_POT:
+      {
+        if(hostModule->control[i].levelCount > 256)
+          hostModule->control[i].levelCount = 256;
+        if(hostModule->control[i].levelCount < 2)
+          hostModule->control[i].levelCount = 2;
+        hostModule->control[i].min = 0;
+        hostModule->control[i].max = hostModule->control[i].levelCount -1;
+        break;
+      }
+      case CM_SELECTOR:
+      {
+        if(hostModule->control[i].levelCount > 12)
+          hostModule->control[i].levelCount = 12;
+        if(hostModule->control[i].levelCount < 2)
+          hostModule->control[i].levelCount = 2;
+        hostModule->control[i].min = 0;
+        hostModule->control[i].max = hostModule->control[i].levelCount -1;
+        break;
+      }
+      case CM_TAPTEMPO:
+      {
+        if(hostModule->control[i].min < 50)
+          hostModule->control[i].min = 50;
+        break;
+      }
+      default:
+        break;
+    }
+  }
+  
+  hostFrame.module = hostModule;
+  hostFrame.init(hostSampleCount);
+  hostAudioIsRunning = true;
+  if(hostModule->pipelined && hostFrame.initPipeline())
+    hostFrame.onStage0Request = hostStage0;
+  
+  hostAcodec.setInputMode(hostModule->inputMode);
+  hostAcodec.init(0);
+  hostAcodec.muteLeftAdcIn = &hostFrame.muteLeftAdcIn;
+  hostAcodec.muteRightAdcIn = &hostFrame.muteRightAdcIn;
+  hostFrame.outCorrectionGain = hostAcodec.outCorrectionGain;
+}
+
+void setDeviceType(DEVICE_TYPE dt){hostDeviceType = dt;}
+
+bool setAudioBlock(int samplesPerBlock, int dmaBuffers)
+{
+  if(hostAudioIsRunning)
+    return false;
+  if((samplesPerBlock < MIN_AUDIO_BLOCK) || (samplesPerBlock > MAX_AUDIO_BLOCK))
+    return false;
+  if((dmaBuffers < MIN_DMA_BUFFERS) || (dmaBuffers > MAX_DMA_BUFFERS))
+    return false;
+  hostSampleCount = samplesPerBlock;
+  hostDmaBufferCount = dmaBuffers;
+  return true;
+}
+
+int getAudioBlock(){return hostSampleCount;}
+int getDmaBufferCount(){return hostDmaBufferCount;}
+float getAudioLatency()
+{
+  int blocks = hostDmaBufferCount + 1;
+  if((hostModule != NULL) && hostModule->pipelined)
+    blocks++;
+  return 1000.0f * (float)(blocks * hostSampleCount) / (float)SAMPLE_RATE;
+}
+
+int getPipelineMissCount(){return hostFrame.stage0Misses;}
+
+//the host has no i2s and no cpu tick budget, only the frame count is reported
+void setDeadlineBudget(float fraction){}
+void getAudioStats(AUDIOSTATS* stats)
+{
+  memset(stats, 0, sizeof(AUDIOSTATS));
+  stats->frames = hostRenderedSamples / hostSampleCount;
+}
+void resetAudioStats(){}
+int getCpuBudgetTicks(){return (int)((int64_t)hostSampleCount * HOST_CPU_FREQ_MHZ * 1000000 / SAMPLE_RATE);}
+
+void enableBleTerminal(void){}
+//no boot sequence on the host, the render starts with the first sample
+unsigned long getBootTime(){return 0;}
+void setOutVol(int vol){hostAcodec.setOutVol(vol);}
+int getOutVol(){return hostAcodec.getOutVol();}
+void setInGain(int gain){hostAcodec.setInGain(gain);}
+int getInGain(){return hostAcodec.getInGain();}
+void optimizeConversion(int range){}
+void setMicGain(int gain){hostAcodec.setMicGain(gain);}
+int getMicGain(){return hostAcodec.getMicGain();}
+void setMicNoiseGate(int gate){hostAcodec.setMicNoiseGate(gate);}
+int getMicNoiseGate(){return hostAcodec.getMicNoiseGate();}
+bool analogBypass(bool bypass, BYPASS_MODE bm){return hostAcodec.analogBypass(bypass, bm);}
+bool analogSoftBypass(bool bypass, BYPASS_MODE bm){return hostAcodec.analogSoftBypass(bypass, bm);}
+
+//cpu usage has no meaning on the host, the renderer reports the throughput instead
+int getTotalCpuTicks(){return 0;}
+int getUsedCpuTicks(){return 0;}
+float getCpuUsage(){return 0;}
+int getAudioFps(){return SAMPLE_RATE/hostSampleCount;}
+
+void runSystemMonitor(int baudRate, int updatePeriod){}
+void runScope(int baudRate, int sampleLength, int triggerChannel, float triggerLevel, bool risingTrigger){}
+void scopeProbe(float sample, int channel){}
+void setDebugStr(const char* str){}
+void setDebugVars(float val1, float val2, float val3, float val4){}
+
+//no core-0 task on the host, the tuner is not available (pitchDetector can be driven directly)
+bool enableTuner(bool enable, TUNER_MODE mode){return false;}
+bool isTunerEnabled(){return false;}
+void setTunerReference(float a4){}
+bool getTunerReading(TUNERREADING* reading)
+{
+  reading->valid = false;
+  return false;
+}
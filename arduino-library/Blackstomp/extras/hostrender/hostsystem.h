@@ -0,0 +1,45 @@
+//Host implementation of the Blackstomp system API (blackstomp.h) for offline rendering
+//there is no i2s, codec, task or pin on the host, the renderer drives the frame processor directly
+#ifndef HOSTSYSTEM_H_
+#define HOSTSYSTEM_H_
+
+#include "blackstomp.h"
+#include "frameprocessor.h"
+
+//nominal cpu frequency used for the cpu budget figures
+#define HOST_CPU_FREQ_MHZ  240
+
+//codec emulation: keeps the analog routing state set by analogBypass() and analogSoftBypass()
+class hostCodec:public codec
+{
+  public:
+    bool dacOut[2];     //digital output enabled on L,R
+    bool analogIn[2];   //analog input routed to the output on L,R
+    int outVol;
+    int inGain;
+    int micGain;
+    int micNoiseGate;
+    
+    hostCodec();
+    bool init(int address);
+    bool setOutVol(int vol){outVol = vol; return true;};
+    int getOutVol(){return outVol;};
+    bool setInGain(int gain){inGain = gain; return true;};
+    int getInGain(){return inGain;};
+    uint8_t getMicGain(){return micGain;};
+    bool setMicGain(uint8_t gain){micGain = gain; return true;};
+    int getMicNoiseGate(){return micNoiseGate;};
+    bool setMicNoiseGate(int gate){micNoiseGate = gate; return true;};
+    bool analogBypass(bool bypass, BYPASS_MODE bm=BM_LR);
+    bool analogSoftBypass(bool bypass, BYPASS_MODE bm=BM_LR);
+};
+
+//the module registered by blackstompSetup()
+extern effectModule* hostModule;
+extern hostCodec hostAcodec;
+extern frameProcessor hostFrame;
+
+//rendered sample count, drives millis() on the host
+extern unsigned long hostRenderedSamples;
+
+#endif
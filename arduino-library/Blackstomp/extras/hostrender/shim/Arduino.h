@@ -0,0 +1,66 @@
+//Host shim of the Arduino core API used by the Blackstomp library and the example sketches
+//only the subset needed for offline rendering is provided
+#ifndef HOST_ARDUINO_H_
+#define HOST_ARDUINO_H_
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <string>
+#include <chrono>
+#include <stdarg.h>
+
+#define INPUT           0x01
+#define OUTPUT          0x03
+#define INPUT_PULLUP    0x05
+
+typedef void* SemaphoreHandle_t;
+typedef void* TaskHandle_t;
+typedef uint32_t TickType_t;
+
+class String
+{
+  private:
+    std::string str;
+  public:
+    String(){}
+    String(const char* s):str(s){}
+    String(const std::string& s):str(s){}
+    const char* c_str() const {return str.c_str();}
+    unsigned int length() const {return str.length();}
+    String substring(unsigned int from, unsigned int to) const {return String(str.substr(from, to-from));}
+    String operator+(const String& s) const {return String(str + s.str);}
+    bool operator==(const String& s) const {return str == s.str;}
+};
+
+//PSRAM allocation is plain heap allocation on the host
+inline void* ps_malloc(size_t size){return malloc(size);}
+
+//pins are not wired on the host
+inline void pinMode(int pin, int mode){}
+inline void digitalWrite(int pin, int val){}
+inline int digitalRead(int pin){return 1;}
+inline int analogRead(int pin){return 0;}
+
+//cpu cycle counter, the host counts nanoseconds instead of cycles
+inline unsigned int xthal_get_ccount()
+{
+  return (unsigned int)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+//serial port output goes to stderr on the host
+class HardwareSerial
+{
+  public:
+    void begin(unsigned long baud){}
+    void flush(){}
+    int printf(const char* format, ...) __attribute__((format(printf, 2, 3)));
+};
+extern HardwareSerial Serial;
+
+unsigned long millis();
+void delay(unsigned long ms);
+
+#endif
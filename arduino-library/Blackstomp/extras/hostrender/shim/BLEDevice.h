@@ -0,0 +1 @@
+//Host shim: intentionally empty, nothing from this header is used in offline rendering
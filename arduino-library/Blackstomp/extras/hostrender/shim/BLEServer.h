@@ -0,0 +1,8 @@
+//Host shim: BLE classes are only referenced through pointers in btterminal.h
+#ifndef HOST_BLESERVER_H_
+#define HOST_BLESERVER_H_
+
+class BLEServer;
+class BLECharacteristic;
+
+#endif
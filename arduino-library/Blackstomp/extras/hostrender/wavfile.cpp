@@ -0,0 +1,121 @@
+#include "wavfile.h"
+#include <stdio.h>
+#include <string.h>
+
+static uint32_t readLE(const uint8_t* p, int bytes)
+{
+  uint32_t val = 0;
+  for(int i=0;i<bytes;i++)
+    val |= (uint32_t)p[i] << (8*i);
+  return val;
+}
+
+static void writeLE(FILE* f, uint32_t val, int bytes)
+{
+  for(int i=0;i<bytes;i++)
+    fputc((val >> (8*i)) & 0xFF, f);
+}
+
+bool wavRead(const char* path, wavData& wav)
+{
+  FILE* f = fopen(path, "rb");
+  if(f == NULL)
+    return false;
+  
+  std::vector<uint8_t> file;
+  uint8_t chunk[65536];
+  size_t n;
+  while((n = fread(chunk, 1, sizeof(chunk), f)) > 0)
+    file.insert(file.end(), chunk, chunk + n);
+  fclose(f);
+
+  if(file.size() < 12 || memcmp(&file[0], "RIFF", 4) || memcmp(&file[8], "WAVE", 4))
+    return false;
+
+  int format = 0;
+  int bits = 0;
+  const uint8_t* data = NULL;
+  uint32_t dataSize = 0;
+  
+  //walk through the chunks
+  size_t pos = 12;
+  while(pos + 8 <= file.size())
+  {
+    const uint8_t* p = &file[pos];
+    uint32_t size = readLE(p+4, 4);
+    if(pos + 8 + size > file.size())
+      size = file.size() - pos - 8;
+    
+    if(!memcmp(p, "fmt ", 4) && size >= 16)
+    {
+      format = readLE(p+8, 2);
+      wav.channelCount = readLE(p+10, 2);
+      wav.sampleRate = readLE(p+12, 4);
+      bits = readLE(p+22, 2);
+      if(format == 0xFFFE && size >= 26) //WAVE_FORMAT_EXTENSIBLE, take the sub format
+        format = readLE(p+32, 2);
+    }
+    else if(!memcmp(p, "data", 4))
+    {
+      data = p+8;
+      dataSize = size;
+    }
+    pos += 8 + size + (size & 1);
+  }
+  
+  if(data == NULL || wav.channelCount < 1)
+    return false;
+  if(!((format == 1 && (bits == 16 || bits == 24 || bits == 32)) || (format == 3 && bits == 32)))
+    return false;
+
+  int bytes = bits/8;
+  wav.frameCount = dataSize / (bytes * wav.channelCount);
+  int count = wav.frameCount * wav.channelCount;
+  wav.samples.resize(count);
+  
+  for(int i=0;i<count;i++)
+  {
+    uint32_t raw = readLE(data + i*bytes, bytes);
+    if(format == 3)
+    {
+      float val;
+      memcpy(&val, &raw, 4);
+      if(val > 1.0f) val = 1.0f;
+      if(val < -1.0f) val = -1.0f;
+      //quantize to 24 bit like the codec does
+      wav.samples[i] = ((int32_t)(val * 8388607.0f)) * 256;
+    }
+    else wav.samples[i] = (int32_t)(raw << (32 - bits));
+  }
+  return true;
+}
+
+bool wavWrite(const char* path, const wavData& wav, int bitsPerSample)
+{
+  FILE* f = fopen(path, "wb");
+  if(f == NULL)
+    return false;
+  
+  int bytes = bitsPerSample/8;
+  uint32_t dataSize = wav.frameCount * wav.channelCount * bytes;
+  
+  fwrite("RIFF", 1, 4, f);
+  writeLE(f, 36 + dataSize, 4);
+  fwrite("WAVEfmt ", 1, 8, f);
+  writeLE(f, 16, 4);
+  writeLE(f, 1, 2); //PCM
+  writeLE(f, wav.channelCount, 2);
+  writeLE(f, wav.sampleRate, 4);
+  writeLE(f, wav.sampleRate * wav.channelCount * bytes, 4);
+  writeLE(f, wav.channelCount * bytes, 2);
+  writeLE(f, bitsPerSample, 2);
+  fwrite("data", 1, 4, f);
+  writeLE(f, dataSize, 4);
+  
+  for(int i=0;i<wav.frameCount * wav.channelCount;i++)
+    writeLE(f, (uint32_t)wav.samples[i] >> (32 - bitsPerSample), bytes);
+  
+  bool ok = !ferror(f);
+  fclose(f);
+  return ok;
+}
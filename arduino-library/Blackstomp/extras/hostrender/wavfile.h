@@ -0,0 +1,23 @@
+//WAV file reader and writer for the host offline renderer
+//samples are kept as interleaved left-justified 32-bit integers, the same layout the i2s driver delivers
+#ifndef WAVFILE_H_
+#define WAVFILE_H_
+
+#include <stdint.h>
+#include <vector>
+
+struct wavData
+{
+  int sampleRate;
+  int channelCount;
+  int frameCount;     //samples per channel
+  std::vector<int32_t> samples;
+};
+
+//read 16, 24, 32-bit PCM or 32-bit float wav file
+bool wavRead(const char* path, wavData& wav);
+
+//write a PCM wav file (bitsPerSample: 16, 24 or 32)
+bool wavWrite(const char* path, const wavData& wav, int bitsPerSample=24);
+
+#endif
@@ -32,6 +32,7 @@
 #include "math.h"
 #include "EEPROM.h"
 #include "codec.h"
+#include "frameprocessor.h"
 
 //CONTROL INPUT
 #define P1_PIN  39
@@ -90,24 +91,30 @@
 #define ES8388_SCK		(GPIO_NUM_23)
 #define ES8388_ADDR		0x10
 
-//audio processing frame length in samples (L+R) 64 samples (32R+32L) 256 Bytes
-#define FRAMELENGTH    64
-//sample count per channel for each frame (32)re
-#define SAMPLECOUNT   FRAMELENGTH/2
+//codec control bus clock (the ES8388 used to run at 32 KHz, go back to 32000 if the board's bus can't keep up)
+#define AC101_BUS_SPEED		400000
+#define ES8388_BUS_SPEED	400000
+
+//input fade-in at the end of the boot sequence
+#define BOOT_FADEIN_MS	20
+
+//default audio processing block: 32 samples per channel, 64 samples (32R+32L) 256 Bytes per frame
+#define DEFAULT_AUDIO_BLOCK   32
 //channel count inside a frame (always stereo = 2)
 #define CHANNELCOUNT  2
-//frame size in bytes
-#define FRAMESIZE   FRAMELENGTH*4
 //audio processing priority
 #define AUDIO_PROCESS_PRIORITY  10
 
-//dma buffer length 32 bytes (8 samples: 4L+4R)
-#define DMABUFFERLENGTH 32
-
+//each dma buffer holds one audio block
 //dma buffer count 20 (640 Bytes: 160 samples: 80L+80R) 
-//#define DMABUFFERCOUNT  20
+//#define DEFAULT_DMA_BUFFERS  20
 //dma buffer count 2 (for 2 ms measured latency)
-#define DMABUFFERCOUNT  2
+#define DEFAULT_DMA_BUFFERS  2
+
+//audio block setting (see setAudioBlock())
+static int _sampleCount = DEFAULT_AUDIO_BLOCK;
+static int _dmaBufferCount = DEFAULT_DMA_BUFFERS;
+static bool _audioIsRunning = false;
 
 //codec instance
 //static AC101 _codec;
@@ -115,13 +122,10 @@ static codec* _acodec;
 //static bool _es8388Mode = false;
 DEVICE_TYPE _deviceType = DT_ESP32_A1S_AC101;
 static uint8_t _codecAddress = 0;
-static bool _muteLeftAdcIn = false;
-static bool _muteRightAdcIn = false;
 
 //effect module pointer
 static effectModule* _module = NULL;
 bool _codecIsReady = false;
-static float _outCorrectionGain = 1;
 static int _optimizedRange = 2;
 
 
@@ -135,15 +139,25 @@ static ledIndicator _auxLed;
 //BLE terminal
 static bt_terminal* btt;
 
-//buffers
-static float wleft[] = {0,0};
-static float wright[] = {0,0};
-static int32_t inbuffer[FRAMELENGTH];
-static int32_t outbuffer[FRAMELENGTH];
-static float inleft[FRAMESIZE];
-static float inright[FRAMESIZE];
-static float outleft[FRAMESIZE];
-static float outright[FRAMESIZE];
+//i2s frame buffers (CHANNELCOUNT x _sampleCount samples)
+static int32_t* inbuffer = NULL;
+static int32_t* outbuffer = NULL;
+
+//frame conversion and effect module processing
+static frameProcessor _frame;
+
+//core-0 stage task of the pipelined mode
+static TaskHandle_t _stage0TaskHandle = NULL;
+
+//chromatic tuner: the audio task feeds the pitch detector, the tuner task on core 0 analyses and reports
+static pitchDetector _pitch;
+static std::atomic<bool> _tunerActive(false);
+static std::atomic<bool> _tunerRestart(false);
+static volatile TUNER_MODE _tunerMode = TM_MUTE;
+static float _tunerReference = 440;
+static TUNERREADING _tunerReading;
+static std::atomic<unsigned int> _tunerSequence(0);  //odd while the reading is being written
+static TaskHandle_t _tunerTaskHandle = NULL;
 
 static unsigned int usedticks;
 static unsigned int availableticks;
@@ -153,6 +167,16 @@ static unsigned int usedticks_start;
 static unsigned int usedticks_end;
 static volatile unsigned int processedframe;
 static unsigned int audiofps;
+
+//audio loop statistics
+static AUDIOSTATS _stats;
+static volatile bool _statsResetRequest = true;
+static float _deadlineFraction = 0.9;
+static unsigned int _deadlineTicks = 0xFFFFFFFF;
+static QueueHandle_t _i2sEventQueue = NULL;
+
+//millis() when the first audio block after the boot sequence was sent out
+static volatile unsigned long _firstAudioTime = 0;
 static char* debugStringPtr = "None";
 static float debugVars[]={0,0,0,0};
 
@@ -187,6 +211,65 @@ void setDeviceType(DEVICE_TYPE dt)
 	_deviceType = dt;
 }
 
+bool setAudioBlock(int samplesPerBlock, int dmaBuffers)
+{
+	if(_audioIsRunning)
+		return false;
+	if((samplesPerBlock < MIN_AUDIO_BLOCK) || (samplesPerBlock > MAX_AUDIO_BLOCK))
+		return false;
+	if((dmaBuffers < MIN_DMA_BUFFERS) || (dmaBuffers > MAX_DMA_BUFFERS))
+		return false;
+	_sampleCount = samplesPerBlock;
+	_dmaBufferCount = dmaBuffers;
+	return true;
+}
+
+int getAudioBlock()
+{
+	return _sampleCount;
+}
+
+int getDmaBufferCount()
+{
+	return _dmaBufferCount;
+}
+
+float getAudioLatency()
+{
+	//one block to fill the input dma buffer, plus the queued output dma buffers
+	int blocks = _dmaBufferCount + 1;
+	//plus one block in flight between the cores in pipelined mode
+	if((_module != NULL) && _module->pipelined)
+		blocks++;
+	return 1000.0f * (float)(blocks * _sampleCount) / (float)SAMPLE_RATE;
+}
+
+void setDeadlineBudget(float fraction)
+{
+	_deadlineFraction = fraction;
+	_deadlineTicks = (unsigned int)(fraction * (float)getCpuBudgetTicks());
+}
+
+void getAudioStats(AUDIOSTATS* stats)
+{
+	*stats = _stats;
+}
+
+void resetAudioStats()
+{
+	_statsResetRequest = true;
+}
+
+int getPipelineMissCount()
+{
+	return _frame.stage0Misses;
+}
+
+int getCpuBudgetTicks()
+{
+	return (int)((int64_t)_sampleCount * ESP.getCpuFreqMHz() * 1000000 / SAMPLE_RATE);
+}
+
 void setDebugVars(float val1, float val2, float val3, float val4)
 {
 	debugVars[0]=val1;
@@ -195,19 +278,37 @@ void setDebugVars(float val1, float val2, float val3, float val4)
 	debugVars[3]=val4;
 }
 
+//update the per-frame statistics with the processing ticks of the last frame
+static void updateFrameStats(unsigned int ticks)
+{
+  if(_statsResetRequest)
+  {
+    memset(&_stats, 0, sizeof(_stats));
+    _statsResetRequest = false;
+  }
+  _stats.frames++;
+  if(ticks > _stats.maxUsedTicks)
+    _stats.maxUsedTicks = ticks;
+  if(ticks > _deadlineTicks)
+    _stats.deadlineMisses++;
+    
+  //log2 scale histogram, bin 0 is below 512 ticks
+  int bin = (ticks < 512) ? 0 : (31 - __builtin_clz(ticks)) - 8;
+  if(bin >= FRAMETICKS_BINS)
+    bin = FRAMETICKS_BINS-1;
+  _stats.ticksHistogram[bin]++;
+}
+
 void i2s_task(void* arg)
 {
   size_t bytesread, byteswritten;
+  int framelength = CHANNELCOUNT * _sampleCount;
+  int framesize = framelength * sizeof(int32_t);
+  setDeadlineBudget(_deadlineFraction);
 
   //initialize all output buffer to zero
-  for(int i= 0; i< FRAMELENGTH; i++)
+  for(int i= 0; i< framelength; i++)
     outbuffer[i] = 0;
-    
-  for(int i=0; i< SAMPLECOUNT; i++)
-  {
-    outleft[i]=0;
-    outright[i]=0;
-  }
 
   usedticks_start = xthal_get_ccount();
   availableticks_start = xthal_get_ccount();
@@ -218,73 +319,78 @@ void i2s_task(void* arg)
     availableticks = availableticks_end - availableticks_start;
     availableticks_start = availableticks_end;
     
-    i2s_read((i2s_port_t)I2S_NUM,(void*) inbuffer, FRAMESIZE, &bytesread, 20);
+    i2s_read((i2s_port_t)I2S_NUM,(void*) inbuffer, framesize, &bytesread, 20);
 
     //used-tick counter starting point
     usedticks_start = xthal_get_ccount();
 
-    if(_control.runningTicks < 1000) //silence the signal during the first 1000 ms startup
+    //zero the missing part of a short (timed out) read instead of processing stale data
+    if(bytesread < (size_t)framesize)
     {
-      for(int k=0;k<SAMPLECOUNT;k++)
-      {
-        inleft[k] = 0;  
-        inright[k] = 0;
-      }
-    }
-    else 
-    for(int i=0,k=0;k<SAMPLECOUNT;k++,i+=2)
-    {
-		if(!_muteLeftAdcIn)
-		{
-		  //convert to 24 bit int then to float
-		  inleft[k] = (float) (inbuffer[i]>>8);
-		  //scale to 1.0
-		  inleft[k] = inleft[k]/8388608;
-		}
-		else inleft[k]=0;
-		
-		if(!_muteRightAdcIn)
-		{
-		  //convert to 24 bit int then to float
-		  inright[k] = (float) (inbuffer[i+1]>>8);
-		  //scale to 1.0
-		  inright[k]=inright[k]/8388608;
-		}
-		else inright[k] = 0;
+      _stats.shortReads++;
+      memset(((uint8_t*)inbuffer) + bytesread, 0, framesize - bytesread);
     }
+
+    //collect the statistics only after the boot sequence (the frame processor is silent until then)
+    if(_frame.silent)
+      _statsResetRequest = true;
   
-    //process the signal by the effect module
-    _module->process(inleft, inright, outleft, outright, SAMPLECOUNT);
+    //tuner tap: one copy of the raw left input, the detection runs on core 0
+    bool tuner = _tunerActive.load(std::memory_order_acquire);
+    if(tuner)
+      _pitch.writeInterleaved(inbuffer, _sampleCount, 0);
+
+    //the module's input is disconnected while the tuner bypasses the dry input to the output
+    if(tuner && (_tunerMode == TM_BYPASS))
+      memset(inbuffer, 0, framesize);
+
+    //convert, process the signal by the effect module, and convert back
+    _frame.process(inbuffer, outbuffer);
     processedframe++;
-    
-    //convert back float to int
-    for(int i=0,k=0;k<SAMPLECOUNT;k++,i+=2)
-    {
-      //scale the left output to 24 bit range
-      outleft[k] = _outCorrectionGain * outleft[k] * 8388607;
-      //saturate to signed 24bit range
-      if(outleft[k]>8388607) outleft[k]=8388607;
-      if(outleft[k]<-8388607) outleft[k]= -8388607;
-
-      //scale the right output to 24 bit range
-      outright[k]=_outCorrectionGain * outright[k] * 8388607;
-      //saturate to signed 24bit range
-      if(outright[k]>8388607) outright[k]=8388607;
-      if(outright[k]<-8388607) outright[k]= -8388607;
-      outbuffer[i] = ((int32_t) outleft[k])<<8;
-      outbuffer[i+1] = ((int32_t) outright[k])<<8;
-    }
+    if(tuner && (_tunerMode == TM_MUTE))
+      memset(outbuffer, 0, framesize);
 
     //used-tick counter end point
     usedticks_end = xthal_get_ccount();
     usedticks = usedticks_end - usedticks_start;
+    updateFrameStats(usedticks);
     
-    i2s_write((i2s_port_t)I2S_NUM,(void*) outbuffer, FRAMESIZE, &byteswritten, 20);
+    i2s_write((i2s_port_t)I2S_NUM,(void*) outbuffer, framesize, &byteswritten, 20);
+    if(byteswritten < (size_t)framesize)
+      _stats.shortWrites++;
+    if((_firstAudioTime == 0) && !_frame.silent)
+      _firstAudioTime = millis();
+      
+    //collect the dma queue overflow events of the i2s driver
+    i2s_event_t i2sevent;
+    while(xQueueReceive(_i2sEventQueue, &i2sevent, 0) == pdTRUE)
+    {
+      if(i2sevent.type == I2S_EVENT_TX_Q_OVF) //no new output frame, the dma resent the old one
+        _stats.underruns++;
+      else if(i2sevent.type == I2S_EVENT_RX_Q_OVF) //input frame dropped, not read in time
+        _stats.overruns++;
+    }
     esp_task_wdt_reset();
   }
   vTaskDelete(NULL);
 }
 
+void stage0_task(void* arg)
+{
+  while(true)
+  {
+    //wait for the i2s_task to queue a frame, then run the core-0 stage on all waiting frames
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    while(_frame.processStage0());
+  }
+  vTaskDelete(NULL);
+}
+
+void requestStage0()
+{
+  xTaskNotifyGive(_stage0TaskHandle);
+}
+
 void i2s_setup()
 {
 	i2s_config_t i2s_config;
@@ -294,8 +400,8 @@ void i2s_setup()
 	i2s_config.channel_format = I2S_CHANNEL_FMT_RIGHT_LEFT; //both channel
 	i2s_config.communication_format = (i2s_comm_format_t) I2S_COMM_FORMAT_I2S;
 
-	i2s_config.dma_buf_count = DMABUFFERCOUNT;
-	i2s_config.dma_buf_len = DMABUFFERLENGTH;
+	i2s_config.dma_buf_count = _dmaBufferCount;
+	i2s_config.dma_buf_len = _sampleCount;
 
 	if(_deviceType==DT_ESP32_A1S_ES8388)
 	{
@@ -311,7 +417,8 @@ void i2s_setup()
 	}
 
 	i2s_config.intr_alloc_flags = ESP_INTR_FLAG_LEVEL1 ;
-	i2s_driver_install((i2s_port_t)I2S_NUM, &i2s_config, 0, NULL);
+	//the event queue reports the dma queue overflows (see i2s_task)
+	i2s_driver_install((i2s_port_t)I2S_NUM, &i2s_config, 8, &_i2sEventQueue);
 
 	i2s_pin_config_t pin_config;
 	if(_deviceType == DT_ESP32_A1S_ES8388)
@@ -547,36 +654,34 @@ void button_task(void* arg)
   }
 }
 
-void codecsetup_task(void* arg)
+static void codecSetup()
 {	
 	if(_deviceType==DT_ESP32_A1S_AC101)
 	{
-		codecBusInit(AC101_SDA, AC101_SCK, 400000);
+		codecBusInit(AC101_SDA, AC101_SCK, AC101_BUS_SPEED);
 		_codecAddress = AC101_ADDR;
 		
 		_acodec = new AC101Codec();
 		_acodec->setInputMode(_module->inputMode);
 		bool res = _acodec->init(_codecAddress);
-		_acodec->muteLeftAdcIn = &_muteLeftAdcIn;
-		_acodec->muteRightAdcIn = &_muteRightAdcIn;
-		_outCorrectionGain = _acodec->outCorrectionGain;
+		_acodec->muteLeftAdcIn = &_frame.muteLeftAdcIn;
+		_acodec->muteRightAdcIn = &_frame.muteRightAdcIn;
+		_frame.outCorrectionGain = _acodec->outCorrectionGain;
 	}
 	else if(_deviceType==DT_ESP32_A1S_ES8388)
 	{
-		codecBusInit(ES8388_SDA,ES8388_SCK, 32000);
+		codecBusInit(ES8388_SDA,ES8388_SCK, ES8388_BUS_SPEED);
 		_codecAddress = ES8388_ADDR;
 		
 		_acodec = new ES8388Codec();
 		_acodec->setInputMode(_module->inputMode);
 		bool res = _acodec->init(_codecAddress);
-		_acodec->muteLeftAdcIn = &_muteLeftAdcIn;
-		_acodec->muteRightAdcIn = &_muteRightAdcIn;
-		_outCorrectionGain = _acodec->outCorrectionGain;
+		_acodec->muteLeftAdcIn = &_frame.muteLeftAdcIn;
+		_acodec->muteRightAdcIn = &_frame.muteRightAdcIn;
+		_frame.outCorrectionGain = _acodec->outCorrectionGain;
 	}
 	_codecIsReady = true;
 	optimizeConversion(_optimizedRange);
-
-	vTaskDelete(NULL);
 }
 
 void eepromupdate_task(void* arg)
@@ -607,47 +712,53 @@ void eepromupdate_task(void* arg)
   }
 }
 
-void eepromsetup_task(void* arg)
+//load the persisted toggle values into the module (the callbacks are called later by applyState())
+static void restoreState()
 {
   if (!EEPROM.begin(sizeof(eeprombuffer)))
   {
     Serial.printf("Failed to initialise EEPROM\n");
+    return;
   }
-  else
+  
+  //load the eeprombuffer from EEPROM
+  uint8_t* pByte = (uint8_t*) &eeprombuffer;
+  for(int i=0;i<sizeof(eeprombuffer);i++)
   {
-    //load the eeprombuffer from EEPROM
-    uint8_t* pByte = (uint8_t*) &eeprombuffer;
-    for(int i=0;i<sizeof(eeprombuffer);i++)
-    {
-      pByte[i]=EEPROM.read(i);
-    }
+    pByte[i]=EEPROM.read(i);
+  }
 
-    //load control values from buffer
-    vTaskDelay(1000);
-    for(int i=0;i<6;i++)
-    {
-      if(_module->control[i].mode == CM_TOGGLE)
-        _module->control[i].value = eeprombuffer.controlvalue[i];
-        
-      //call all enabled control callbacks at first run
-      if(_module->control[i].mode != CM_DISABLED)
-        _module->onControlChange(i);
-    }
-    
-    //load buton values from buffer
-    for(int i=0;i<4;i++)
-    {
-      if(_module->button[i].mode == BM_TOGGLE)
-      {
-        _module->button[i].value = eeprombuffer.buttonvalue[i];
-        _module->onButtonChange(i);
-      }
-    }
+  //load control values from buffer
+  for(int i=0;i<6;i++)
+  {
+    if(_module->control[i].mode == CM_TOGGLE)
+      _module->control[i].value = eeprombuffer.controlvalue[i];
+  }
+  
+  //load buton values from buffer
+  for(int i=0;i<4;i++)
+  {
+    if(_module->button[i].mode == BM_TOGGLE)
+      _module->button[i].value = eeprombuffer.buttonvalue[i];
+  }
+}
 
+//pass the restored state to the module
+static void applyState()
+{
+  //call all enabled control callbacks at first run
+  for(int i=0;i<6;i++)
+  {
+    if(_module->control[i].mode != CM_DISABLED)
+      _module->onControlChange(i);
   }
   
-  xTaskCreatePinnedToCore(eepromupdate_task, "eepromupdate_task", 4096, NULL, AUDIO_PROCESS_PRIORITY, NULL,0);
-  vTaskDelete(NULL);
+  //call the toggle button callbacks
+  for(int i=0;i<4;i++)
+  {
+    if(_module->button[i].mode == BM_TOGGLE)
+      _module->onButtonChange(i);
+  }
 }
 
 void blackstompSetup(effectModule* module) 
@@ -696,18 +807,48 @@ void blackstompSetup(effectModule* module)
 	  }
   }
 	
+	//allocate the i2s frame buffers and prepare the frame processor
+	inbuffer = new int32_t[CHANNELCOUNT * _sampleCount];
+	outbuffer = new int32_t[CHANNELCOUNT * _sampleCount];
+	_frame.module = _module;
+	_frame.init(_sampleCount);
+	_audioIsRunning = true;
+	
+	//pipelined mode: the module's first stage runs on core 0, above the control tasks' priority
+	if(_module->pipelined && _frame.initPipeline())
+	{
+		xTaskCreatePinnedToCore(stage0_task, "stage0_task", 4096, NULL, AUDIO_PROCESS_PRIORITY+1, &_stage0TaskHandle,0);
+		_frame.onStage0Request = requestStage0;
+	}
+
+	//BOOT SEQUENCE
+	//the state is restored and applied before the audio starts, the audio starts with a short fade-in
+	_frame.silent = true;
+	
+	//restore the persisted values
+	restoreState();
+	
+	//assign the module to control and read the current control positions
+	_control.module = _module;
+	_control.init(P1_PIN,P2_PIN,P3_PIN,P4_PIN,P5_PIN,P6_PIN);
+
 	//setup the i2S 
 	i2s_setup();
-	//the main audio task, dedicated on core 1
+	//the main audio task, dedicated on core 1 (silent until the end of the boot sequence)
 	xTaskCreatePinnedToCore(i2s_task, "i2s_task", 4096, NULL, AUDIO_PROCESS_PRIORITY, NULL,1);
-	delay(100);
-
-	//codec setup
-	xTaskCreatePinnedToCore(codecsetup_task, "codecsetup_task", 4096, NULL, AUDIO_PROCESS_PRIORITY, NULL,0);
+	
+	//codec setup, once the i2s clocks are running (the AC101 derives its clock from the bit clock)
+	while(processedframe == 0)
+		delay(1);
+	codecSetup();
+	
+	//apply the state through the module's callbacks, then start the audio
+	applyState();
+	_frame.fadeIn(BOOT_FADEIN_MS * SAMPLE_RATE / 1000);
 
-	//assign the module to control and start it
-	_control.module = _module;
-	_control.init(P1_PIN,P2_PIN,P3_PIN,P4_PIN,P5_PIN,P6_PIN,AUDIO_PROCESS_PRIORITY);
+	//BACKGROUND SERVICES
+	//start the control task
+	_control.start(AUDIO_PROCESS_PRIORITY);
 
 	//decoding button press on main button port and encoder port
 	xTaskCreatePinnedToCore(button_task, "button_task", 4096, NULL, AUDIO_PROCESS_PRIORITY, NULL,0);
@@ -716,7 +857,206 @@ void blackstompSetup(effectModule* module)
 	xTaskCreatePinnedToCore(framecounter_task, "framecounter_task", 4096, NULL, AUDIO_PROCESS_PRIORITY, NULL,0);
 
 	//run eeprom service to manage saving some parameter control change in limited update frequency to save the flash from aging
-	xTaskCreatePinnedToCore(eepromsetup_task, "eepromsetup_task", 4096, NULL, AUDIO_PROCESS_PRIORITY, NULL,0);
+	xTaskCreatePinnedToCore(eepromupdate_task, "eepromupdate_task", 4096, NULL, AUDIO_PROCESS_PRIORITY, NULL,0);
+}
+
+unsigned long getBootTime()
+{
+	return _firstAudioTime;
+}
+
+//CHROMATIC TUNER
+//analysed at SAMPLE_RATE/2, from below the drop tunings' low notes up to the 24th fret of the high E string
+#define TUNER_DECIMATION      2
+#define TUNER_MIN_FREQUENCY   60
+#define TUNER_MAX_FREQUENCY   1400
+//detection period: 33 ms window + 50 ms period keep the reading below 100 ms behind the string
+#define TUNER_PERIOD_MS       50
+#define TUNER_INTUNE_CENTS    3
+#define TUNER_BLINK_CENTS     20
+
+static const char* _noteNames[] = {"C","C#","D","D#","E","F","F#","G","G#","A","A#","B"};
+
+enum {tl_off, tl_intune, tl_flat, tl_flatfar, tl_sharp, tl_sharpfar};
+
+static void showTunerLeds(int state)
+{
+  switch(state)
+  {
+    case tl_intune: _mainLed.turnOn(); _auxLed.turnOn(); break;
+    case tl_flat: _mainLed.turnOn(); _auxLed.turnOff(); break;
+    case tl_flatfar: _mainLed.blink(8,8,1,0,0); _auxLed.turnOff(); break;
+    case tl_sharp: _mainLed.turnOff(); _auxLed.turnOn(); break;
+    case tl_sharpfar: _mainLed.turnOff(); _auxLed.blink(8,8,1,0,0); break;
+    default: _mainLed.turnOff(); _auxLed.turnOff(); break;
+  }
+}
+
+void tuner_task(void* arg)
+{
+  bool running = false;
+  bool tracking = false;
+  float smoothed = 0;   //note number with the fraction
+  int ledState = -1;
+  char message[40];
+  std::string lastMessage;
+  
+  while(true)
+  {
+    vTaskDelay(TUNER_PERIOD_MS);
+    if(!_tunerActive.load(std::memory_order_acquire))
+    {
+      //stopped: hand the leds back to the module (enableTuner() restores the codec routing)
+      if(running)
+      {
+        running = false;
+        _mainLed.restoreState();
+        _auxLed.restoreState();
+      }
+      continue;
+    }
+    if(_tunerRestart.exchange(false))
+    {
+      if(!running)
+      {
+        _mainLed.saveState();
+        _auxLed.saveState();
+      }
+      _pitch.reset();
+      running = true;
+      tracking = false;
+      ledState = -1;
+      lastMessage.clear();
+    }
+    if(!_pitch.update())
+      continue;
+    
+    TUNERREADING reading;
+    reading.frequency = _pitch.getFrequency();
+    reading.clarity = _pitch.getClarity();
+    reading.valid = reading.frequency > 0;
+    if(reading.valid)
+    {
+      //light smoothing while the note holds, a new note is taken at once
+      float n = 69.0f + 12.0f * log2f(reading.frequency / _tunerReference);
+      if(tracking && (fabsf(n - smoothed) < 0.5f))
+        smoothed += 0.5f * (n - smoothed);
+      else smoothed = n;
+      tracking = true;
+      reading.note = (int)floorf(smoothed + 0.5f);
+      reading.cents = 100.0f * (smoothed - (float)reading.note);
+      reading.name = _noteNames[reading.note % 12];
+      reading.octave = reading.note / 12 - 1;
+    }
+    else
+    {
+      tracking = false;
+      reading.note = 0;
+      reading.cents = 0;
+      reading.name = "";
+      reading.octave = 0;
+    }
+    
+    //seqlock: odd sequence while the reading changes
+    unsigned int seq = _tunerSequence.load(std::memory_order_relaxed);
+    _tunerSequence.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    _tunerReading = reading;
+    _tunerSequence.store(seq + 2, std::memory_order_release);
+    
+    //leds, updated only when the state changes (a blink restarts when it's set)
+    int state = tl_off;
+    if(reading.valid)
+    {
+      if(fabsf(reading.cents) <= TUNER_INTUNE_CENTS)
+        state = tl_intune;
+      else if(reading.cents < 0)
+        state = (reading.cents < -TUNER_BLINK_CENTS) ? tl_flatfar : tl_flat;
+      else state = (reading.cents > TUNER_BLINK_CENTS) ? tl_sharpfar : tl_sharp;
+    }
+    if(state != ledState)
+    {
+      showTunerLeds(state);
+      ledState = state;
+    }
+    
+    //BLE terminal notification, only when the shown reading changes
+    if((btt != NULL) && btt->deviceConnected && btt->authenticated)
+    {
+      if(reading.valid)
+        snprintf(message, sizeof(message), "TUNER %s%d %+.0f %.1f", reading.name, reading.octave, reading.cents, reading.frequency);
+      else snprintf(message, sizeof(message), "TUNER -");
+      if(lastMessage != message)
+      {
+        lastMessage = message;
+        btt->sendresponse(lastMessage);
+      }
+    }
+  }
+  vTaskDelete(NULL);
+}
+
+bool enableTuner(bool enable, TUNER_MODE mode)
+{
+  if(!_audioIsRunning)
+    return false;
+  if(!enable)
+  {
+    //the module's routing comes back at once, the tuner task restores the leds at its next period
+    _tunerActive.store(false, std::memory_order_release);
+    if(_codecIsReady)
+      _acodec->tunerRouting(TR_OFF);
+    return true;
+  }
+  
+  if(_tunerTaskHandle == NULL)
+  {
+    if(!_pitch.init(TUNER_MIN_FREQUENCY, TUNER_MAX_FREQUENCY, TUNER_DECIMATION))
+      return false;
+    //below the control tasks, above the system monitor and the analyzers
+    xTaskCreatePinnedToCore(tuner_task, "tuner_task", 4096, NULL, AUDIO_PROCESS_PRIORITY-1, &_tunerTaskHandle,0);
+    if(_tunerTaskHandle == NULL)
+      return false;
+  }
+  
+  //mute or bypass at the codec (over the module's own analog bypass), keep the left adc for the detector
+  bool active = _tunerActive.load(std::memory_order_acquire);
+  _tunerMode = mode;
+  if(_codecIsReady)
+    _acodec->tunerRouting((mode == TM_MUTE) ? TR_MUTE : ((mode == TM_BYPASS) ? TR_BYPASS : TR_THROUGH));
+  if(!active)
+  {
+    _tunerRestart.store(true, std::memory_order_relaxed);
+    _tunerActive.store(true, std::memory_order_release);
+  }
+  return true;
+}
+
+bool isTunerEnabled()
+{
+  return _tunerActive.load(std::memory_order_acquire);
+}
+
+void setTunerReference(float a4)
+{
+  if(a4 > 0)
+    _tunerReference = a4;
+}
+
+bool getTunerReading(TUNERREADING* reading)
+{
+  for(int tries=0;tries<8;tries++)
+  {
+    unsigned int seq = _tunerSequence.load(std::memory_order_acquire);
+    if((seq == 0) || (seq & 1))
+      continue;
+    *reading = _tunerReading;
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if(_tunerSequence.load(std::memory_order_relaxed) == seq)
+      return reading->valid;
+  }
+  reading->valid = false;
+  return false;
 }
 
 void sysmon_task(void *arg)
@@ -735,7 +1075,31 @@ void sysmon_task(void *arg)
 	  Serial.printf("\nAPPLICATION INFO:\n");
 	  Serial.printf("Pedal Name: %s\n",_module->name.c_str());
 	  Serial.printf("Audio frame per second: %d fps\n",getAudioFps());
+	  Serial.printf("Boot to first audio: %lu ms\n",getBootTime());
+	  Serial.printf("Audio block: %d samples, %d dma buffers, latency: %.2f ms\n",getAudioBlock(),getDmaBufferCount(),getAudioLatency());
+	  Serial.printf("CPU ticks budget per frame: %d\n",getCpuBudgetTicks());
 	  Serial.printf("CPU ticks per frame period: %d\n",getTotalCpuTicks());
+	  if(_module->pipelined)
+		Serial.printf("Pipeline stage misses: %d\n",getPipelineMissCount());
+	  AUDIOSTATS stats;
+	  getAudioStats(&stats);
+	  Serial.printf("Max used CPU ticks: %u, over %.0f%% budget: %u of %u frames\n",stats.maxUsedTicks,100.0*_deadlineFraction,stats.deadlineMisses,stats.frames);
+	  Serial.printf("Underruns: %u, overruns: %u, short reads: %u, short writes: %u\n",stats.underruns,stats.overruns,stats.shortReads,stats.shortWrites);
+	  if(getProfileStageCount() > 0)
+	  {
+		  char report[PROFILE_MAXSTAGES*64];
+		  getProfileReport(report, sizeof(report));
+		  Serial.printf("Stage profile:\n%s", report);
+	  }
+	  Serial.printf("Used CPU ticks histogram:");
+	  for(int i=0;i<FRAMETICKS_BINS-1;i++)
+	  {
+		  if(stats.ticksHistogram[i])
+			Serial.printf(" <%u:%u",1u<<(i+9),stats.ticksHistogram[i]);
+	  }
+	  if(stats.ticksHistogram[FRAMETICKS_BINS-1])
+		Serial.printf(" >=%u:%u",1u<<(FRAMETICKS_BINS+7),stats.ticksHistogram[FRAMETICKS_BINS-1]);
+	  Serial.printf("\n");
 	  Serial.printf("Used CPU ticks: %d\n",getUsedCpuTicks());
 	  Serial.printf("CPU Usage: %.2f %%\n", 100.0*getCpuUsage());
 	  for(int i=0;i<6;i++)
@@ -748,6 +1112,13 @@ void sysmon_task(void *arg)
 		  if(_module->button[i].mode != CM_DISABLED)
 			Serial.printf("BUTTON-%d: %d\n",i,_module->button[i].value);
 	  }
+	  if(isTunerEnabled())
+	  {
+		  TUNERREADING reading;
+		  if(getTunerReading(&reading))
+			Serial.printf("Tuner: %s%d %+.1f cents (%.2f Hz, clarity %.2f)\n",reading.name,reading.octave,reading.cents,reading.frequency,reading.clarity);
+		  else Serial.printf("Tuner: no pitch\n");
+	  }
 	  char debugstring[51];
 	  strncpy(debugstring,debugStringPtr,50);
 	  Serial.printf("Debug String: %s\n", debugstring);
@@ -875,6 +1246,10 @@ void scopeProbe(float sample, int channel)
 
 void enableBleTerminal(void)
 {
+	//keep the BLE stack startup out of the boot sequence
+	while(_firstAudioTime == 0)
+		delay(1);
+		
 	btt = new bt_terminal();
 	btt->module = _module;
 	
@@ -29,26 +29,98 @@
 #define BLACKSTOMP_H_
 
 #define SAMPLE_RATE     (44100)
+
+//audio block size (samples per channel) and dma buffer count limits, see setAudioBlock()
+#define MIN_AUDIO_BLOCK   8
+#define MAX_AUDIO_BLOCK   256
+#define MIN_DMA_BUFFERS   2
+#define MAX_DMA_BUFFERS   128
+
 #include "bsdsp.h"
+#include "bsfixed.h"
+#include "bsfft.h"
 #include "effectmodule.h"
 #include "control.h"
 #include "ledindicator.h"
 #include "btterminal.h"
 #include "codec.h"
+#include "profiler.h"
+
+//number of the log2 scale bins of the processing ticks histogram in AUDIOSTATS
+#define FRAMETICKS_BINS   16
+
+//audio loop statistics, see getAudioStats()
+struct AUDIOSTATS
+{
+  unsigned int frames;          //processed frames
+  unsigned int underruns;       //output dma ran out of new frames (i2s tx queue overflow)
+  unsigned int overruns;        //input frames dropped by the dma, not read in time (i2s rx queue overflow)
+  unsigned int shortReads;      //i2s_read() timed out before a full frame, the missing samples are zeroed
+  unsigned int shortWrites;     //i2s_write() timed out before the whole frame was queued
+  unsigned int deadlineMisses;  //frames whose processing ticks exceeded the deadline budget
+  unsigned int maxUsedTicks;    //worst-case processing ticks of a frame
+  unsigned int ticksHistogram[FRAMETICKS_BINS]; //bin 0: below 512 ticks, bin n: 2^(n+8) to 2^(n+9)-1 ticks, the last bin is open-ended
+};
+
+//tuner output while the tuner is active, see enableTuner()
+typedef enum
+{
+  TM_MUTE,      //silent output, muted at the codec (default)
+  TM_BYPASS,    //analog soft bypass: the dry input goes to the output, the digital input is disconnected
+  TM_THROUGH    //the effect keeps running (with the module's own bypass routing)
+}
+TUNER_MODE;
+
+//chromatic tuner reading, see getTunerReading()
+struct TUNERREADING
+{
+  bool valid;         //false while no pitch is detected
+  float frequency;    //Hz
+  int note;           //nearest MIDI note number (69 = A4)
+  const char* name;   //note name ("C", "C#", .. "B")
+  int octave;         //scientific pitch notation (A4, E2, ..)
+  float cents;        //deviation from the nearest note, -50 .. 50
+  float clarity;      //periodicity of the signal, 0 .. 1
+};
 
 //BLACKSTOMP'S SYSTEM API
 
 //Blackstomp core setup, 
 //should be called inside arduino platform's setup()
+//it restores the saved state, starts the codec and returns when the audio is running
 void blackstompSetup(effectModule* module); 
 
 //Set device type (currently supported types: DT_ESP32_A1S_AC101 (DEFAULT) and DT_ESP32_A1S_ES8388)
 void setDeviceType(DEVICE_TYPE dt);
 
+//Set the audio processing block size (samples per channel passed to process()) and the i2s dma buffer count,
+//should be called (if needed) before blackstompSetup() or inside the module's init(), default: 32 samples, 2 buffers
+//larger blocks lower the per-block call overhead, smaller blocks and fewer buffers lower the latency
+//samplesPerBlock: 8-256, dmaBuffers: 2-128, returns false if the setting is rejected
+bool setAudioBlock(int samplesPerBlock=32, int dmaBuffers=2);
+
+//audio block size (samples per channel) and dma buffer count in use
+int getAudioBlock();
+int getDmaBufferCount();
+
+//estimated round-trip latency in milliseconds (excluding the codec's converter delay)
+//it includes the one block added by the pipelined mode (effectModule::pipelined)
+float getAudioLatency();
+
+//number of blocks where the core-0 stage output was not ready in time (pipelined mode)
+int getPipelineMissCount();
+
+//Cpu ticks available for processing one audio block at the current cpu frequency
+int getCpuBudgetTicks();
+
 //enable BLE (bluetooth low energy) terminal, 
 //should be called (if needed) ater blackstompSetup() inside arduino platform's setup()
+//the BLE stack starts after the first audio block has been sent out
 void enableBleTerminal(void);
 
+//time from power-up to the first audio block sent out after the boot sequence, in milliseconds (0 until then)
+unsigned long getBootTime();
+
 //set the output level (analog gain)
 //vol = 0-30 for ES83-version module
 //vol = 0-31 for AC101-version module
@@ -104,6 +176,30 @@ float getCpuUsage();
 //audio frames per second
 int getAudioFps();     
 
+//set the deadline budget as a fraction of getCpuBudgetTicks(), default: 0.9
+//frames whose processing takes longer are counted in AUDIOSTATS::deadlineMisses
+void setDeadlineBudget(float fraction=0.9);
+
+//copy the audio loop statistics (xruns, short reads, worst-case and histogram of the processing ticks)
+void getAudioStats(AUDIOSTATS* stats);
+
+//clear the audio loop statistics (done by the audio task at the next frame)
+void resetAudioStats();
+
+//start or stop the chromatic tuner,
+//the audio task copies the left input into a ring, the pitch detection runs on core 0 (20 readings per second),
+//the reading is shown by the leds (both on: in tune, main led: flat, aux led: sharp, blinking: more than 20 cents off)
+//and sent to the connected BLE terminal, the codec routing of the tuner mode overrides the module's analog bypass,
+//the module's routing (including its bypass calls while the tuner runs) and its leds come back when it stops
+bool enableTuner(bool enable, TUNER_MODE mode=TM_MUTE);
+bool isTunerEnabled();
+
+//reference frequency of A4 in Hz, default: 440
+void setTunerReference(float a4=440);
+
+//copy the latest tuner reading, returns reading->valid
+bool getTunerReading(TUNERREADING* reading);
+
 //run system monitor on serial port, should be called on arduino setup when needed
 //don't call this function when runScope function has been called
 //don't call this function when MIDI is implemented
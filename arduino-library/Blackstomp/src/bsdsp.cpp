@@ -28,6 +28,7 @@
 #include "bsdsp.h"
 #include "blackstomp.h"
 #include <math.h>
+#include <string.h>
 
 //######################################################################
 // LOOKUPLINEAR
@@ -40,7 +41,30 @@ float lookupLinear(float x, const float* table)
 
 //######################################################################
 // SINE OSCILLATOR
-#define MAXPHASE 255.0
+// 32-bit phase (one cycle = 2^32, the wrap is the integer overflow), mapped to 0 .. 255.0 for the wave table
+#define PHASE_TO_TABLE	(255.0f/16777216.0f)
+#define TABLE_TO_PHASE	(4294967296.0f/255.0f)
+
+static inline float tablePosition(uint32_t p)
+{
+  //the top 24 bits, always below 255.0 so table[index+1] stays inside the table
+  return (float)(p >> 8) * PHASE_TO_TABLE;
+}
+
+//0 .. 255.0 table position (any value, wrapped) to a 32-bit phase
+static inline uint32_t tablePhase(float p)
+{
+  p = p - 255.0f * floorf(p * (1.0f/255.0f));
+  return (uint32_t)(p * TABLE_TO_PHASE);
+}
+
+static inline uint32_t phaseIncrement(float freq)
+{
+  if(freq < 0) freq = 0;
+  if(freq > 0.5f*(float)SAMPLE_RATE) freq = 0.5f*(float)SAMPLE_RATE;
+  return (uint32_t)(freq * (4294967296.0f/(float)SAMPLE_RATE));
+}
+
 oscillator::oscillator()
 {
 	phase = 0;
@@ -58,200 +82,1527 @@ void oscillator::setWaveTable(const float* wtable)
 
 void oscillator::update()
 {
-  phase = phase + phaseincrement;
-  if(phase > MAXPHASE)
-    phase = phase-MAXPHASE;
+  phase += phaseincrement;
 }
 
 void oscillator::setPhase(float p)
 {
-	phase = p;
+	phase = tablePhase(p);
 }
 
 void oscillator::setFrequency(float freq)
 {
-  phaseincrement = freq * MAXPHASE /(float)SAMPLE_RATE;
+  phaseincrement = phaseIncrement(freq);
 }
 
 float oscillator::getOutput(float phaseOffset)
 {
-  float p = phase + phaseOffset;
-  if(p>MAXPHASE)
-    p = p - MAXPHASE;
-  return lookupLinear(p,waveTable);
+  uint32_t p = phase + tablePhase(phaseOffset);
+  return lookupLinear(tablePosition(p),waveTable);
 }
 
 float oscillator::getOutput()
 {
-  return lookupLinear(phase,waveTable);
+  return lookupLinear(tablePosition(phase),waveTable);
+}
+
+//######################################################################
+// OSCILLATOR BANK
+#define PHASE_TO_UNIT	(1.0f/16777216.0f)
+
+//phase as 0 .. 1.0 (top 24 bits)
+static inline float unitPhase(uint32_t p)
+{
+  return (float)(p >> 8) * PHASE_TO_UNIT;
+}
+
+//polyBLEP residual around the discontinuity at t = 0, dt = phase increment, k = 1/dt
+static inline float polyBlep(float t, float dt, float k)
+{
+  if(t < dt)
+  {
+    float x = t * k;
+    return x + x - x * x - 1.0f;
+  }
+  if(t > 1.0f - dt)
+  {
+    float x = (t - 1.0f) * k;
+    return x * x + x + x + 1.0f;
+  }
+  return 0;
+}
+
+//one waveform block from phase p, the shape is selected once per block
+static void oscillatorBlock(OSC_SHAPE shape, const float* table, uint32_t p, uint32_t inc, float* out, int sampleCount)
+{
+  switch(shape)
+  {
+    case OS_TRIANGLE:
+    {
+      //a quarter cycle ahead so it starts at 0 rising like the sine
+      p += 0x40000000;
+      for(int i=0;i<sampleCount;i++)
+      {
+        out[i] = 1.0f - 4.0f * fabsf(unitPhase(p) - 0.5f);
+        p += inc;
+      }
+      break;
+    }
+    case OS_SAW:
+    {
+      float dt = unitPhase(inc);
+      float k = (dt > 0) ? 1.0f/dt : 0;
+      for(int i=0;i<sampleCount;i++)
+      {
+        float t = unitPhase(p);
+        out[i] = 2.0f * t - 1.0f - polyBlep(t, dt, k);
+        p += inc;
+      }
+      break;
+    }
+    case OS_SQUARE:
+    {
+      float dt = unitPhase(inc);
+      float k = (dt > 0) ? 1.0f/dt : 0;
+      for(int i=0;i<sampleCount;i++)
+      {
+        float t = unitPhase(p);
+        float y = (t < 0.5f) ? 1.0f : -1.0f;
+        out[i] = y + polyBlep(t, dt, k) - polyBlep(unitPhase(p + 0x80000000), dt, k);
+        p += inc;
+      }
+      break;
+    }
+    default: //OS_SINE, OS_TABLE
+    {
+      for(int i=0;i<sampleCount;i++)
+      {
+        out[i] = lookupLinear(tablePosition(p), table);
+        p += inc;
+      }
+      break;
+    }
+  }
+}
+
+oscillatorBank::oscillatorBank(int oscillatorCount)
+{
+  count = oscillatorCount;
+  phases = new uint32_t[count];
+  increments = new uint32_t[count];
+  shapes = new OSC_SHAPE[count];
+  tables = new const float*[count];
+  values = new float[count];
+  for(int i=0;i<count;i++)
+  {
+    phases[i] = 0;
+    increments[i] = 0;
+    shapes[i] = OS_SINE;
+    tables[i] = sin_table;
+    values[i] = 0;
+  }
+}
+
+oscillatorBank::~oscillatorBank()
+{
+  delete[] phases;
+  delete[] increments;
+  delete[] shapes;
+  delete[] tables;
+  delete[] values;
+}
+
+int oscillatorBank::getCount()
+{
+  return count;
+}
+
+void oscillatorBank::setFrequency(int index, float freq)
+{
+  increments[index] = phaseIncrement(freq);
+}
+
+void oscillatorBank::setPhase(int index, float p)
+{
+  phases[index] = (uint32_t)((p - floorf(p)) * 4294967296.0f);
+}
+
+void oscillatorBank::setShape(int index, OSC_SHAPE shape)
+{
+  shapes[index] = shape;
+  if(shape == OS_SINE)
+    tables[index] = sin_table;
+}
+
+void oscillatorBank::setWaveTable(int index, const float* wtable)
+{
+  tables[index] = (wtable == NULL) ? sin_table : wtable;
+  shapes[index] = OS_TABLE;
+}
+
+void oscillatorBank::generate(int index, float* out, int sampleCount)
+{
+  oscillatorBlock(shapes[index], tables[index], phases[index], increments[index], out, sampleCount);
+  phases[index] += increments[index] * (uint32_t)sampleCount;
+}
+
+void oscillatorBank::generate(int index, float* const* outs, const float* phaseOffsets, int outputCount, int sampleCount)
+{
+  for(int k=0;k<outputCount;k++)
+  {
+    float o = phaseOffsets[k] - floorf(phaseOffsets[k]);
+    uint32_t offset = (uint32_t)(o * 4294967296.0f);
+    oscillatorBlock(shapes[index], tables[index], phases[index] + offset, increments[index], outs[k], sampleCount);
+  }
+  phases[index] += increments[index] * (uint32_t)sampleCount;
+}
+
+void oscillatorBank::generateQuadrature(int index, float* out0, float* out90, int sampleCount)
+{
+  oscillatorBlock(shapes[index], tables[index], phases[index], increments[index], out0, sampleCount);
+  oscillatorBlock(shapes[index], tables[index], phases[index] + 0x40000000, increments[index], out90, sampleCount);
+  phases[index] += increments[index] * (uint32_t)sampleCount;
+}
+
+float oscillatorBank::shapeValue(int index, uint32_t p)
+{
+  float y;
+  oscillatorBlock(shapes[index], tables[index], p, increments[index], &y, 1);
+  return y;
+}
+
+void oscillatorBank::update(int sampleCount)
+{
+  for(int i=0;i<count;i++)
+  {
+    values[i] = shapeValue(i, phases[i]);
+    phases[i] += increments[i] * (uint32_t)sampleCount;
+  }
+}
+
+float oscillatorBank::getValue(int index)
+{
+  return values[index];
 }
 
 //######################################################################
 // BIQUAD FILTER
-// Implementation of direct-form-2 biquad iir filter
+// direct form 2, with ESP-DSP's Xtensa biquad kernel running each stage over the whole block when it's available,
+// otherwise sample by sample through all the stages (the stages overlap, faster than stage by stage in C),
+// define BLACKSTOMP_PORTABLE_BIQUAD in the build flags to measure the portable path on the device
+
+#if defined(ARDUINO_ARCH_ESP32) && defined(__has_include) && !defined(BLACKSTOMP_PORTABLE_BIQUAD)
+#if __has_include(<dsps_biquad.h>)
+#include <dsps_biquad.h>
+#define BIQUAD_USE_DSPS
+#endif
+#endif
+
+//floats per stage in the coefficient and state arrays (16-byte aligned stages)
+#define BIQUAD_COEF_STRIDE	8
+#define BIQUAD_STATE_STRIDE	4
 
-//direct-form-2 biquad iir filter
-struct biquadState
+//stored as b0, b1, b2, a1, a2 with the usual sign (y = b0.x + b1.x1 + b2.x2 - a1.y1 - a2.y2) for ESP-DSP
+static void storeBiquadCoef(float* dest, const float* coef, int stages)
 {
-  float coef[5]; //a1, a2, b0, b1, b2
-  float w[2];
-};
+  for(int i=0;i<stages;i++)
+  {
+    float* c = dest + i * BIQUAD_COEF_STRIDE;
+    c[0] = coef[(5*i)];
+    c[1] = coef[(5*i)+1];
+    c[2] = coef[(5*i)+2];
+    c[3] = -coef[(5*i)+3];
+    c[4] = -coef[(5*i)+4];
+  }
+}
+
+static void copyBiquadCoef(float* dest, const float* src, int stages)
+{
+  for(int i=0;i<stages * BIQUAD_COEF_STRIDE;i++)
+    dest[i] = src[i];
+}
+
+biquadCoefExchange::biquadCoefExchange()
+{
+  for(int i=0;i<3;i++)
+    slots[i] = NULL;
+  stages = 0;
+  front = 0;
+  back = 1;
+  applied = false;
+  published = 2;
+  committing.clear();
+}
+
+void biquadCoefExchange::init(float* memory, int stageCount)
+{
+  stages = stageCount;
+  for(int i=0;i<3;i++)
+    slots[i] = memory + i * stages * BIQUAD_COEF_STRIDE;
+}
+
+void biquadCoefExchange::publish(const float* coef, bool ramp)
+{
+  while(committing.test_and_set(std::memory_order_acquire));
+  storeBiquadCoef(slots[back], coef, stages);
+  back = published.exchange(back | FRESH | (ramp ? RAMP : 0), std::memory_order_acq_rel) & 3;
+  committing.clear(std::memory_order_release);
+}
+
+const float* biquadCoefExchange::acquire(bool* ramp)
+{
+  if(!(published.load(std::memory_order_acquire) & FRESH))
+    return NULL;
+  //the swap takes the latest set and its flags at once, a set published after it stays FRESH for the next block
+  int p = published.exchange(front, std::memory_order_acq_rel);
+  front = p & 3;
+  *ramp = applied && (p & RAMP);
+  applied = true;
+  return slots[front];
+}
 
 biquadFilter::biquadFilter(int stageCount)
 {
   stages = stageCount;
-  biquadState* s = new biquadState[stages];
-  states = (void*) s;
+  //one allocation for the coefficients, the 3 exchange slots and the states, with room for the 16-byte alignment
+  int length = stages * (4 * BIQUAD_COEF_STRIDE + BIQUAD_STATE_STRIDE);
+  memory = new float[length + 4];
+  coefs = (float*)(((uintptr_t)memory + 15) & ~(uintptr_t)15);
+  exchange.init(coefs + stages * BIQUAD_COEF_STRIDE, stages);
+  states = coefs + 4 * stages * BIQUAD_COEF_STRIDE;
+  for(int i=0;i<length;i++)
+    coefs[i]=0;
+}
+
+biquadFilter::~biquadFilter()
+{
+  delete[] memory;
+}
+
+void biquadFilter::setCoef(const float* coef)
+{
+  exchange.publish(coef, false);
+}
+
+void biquadFilter::setCoef(const float* coef, bool interpolate)
+{
+  exchange.publish(coef, interpolate);
+}
+
+//reader side of the exchange at the block boundary (all the biquad cascades): a new set is applied at once,
+//or returned as the targets to ramp to over the block (NULL if there's nothing to ramp to)
+static const float* updateBiquadCoef(biquadCoefExchange& exchange, float* coefs, int stages, int sampleCount)
+{
+  bool ramp = false;
+  const float* t = exchange.acquire(&ramp);
+  if(t == NULL)
+    return NULL;
+  if(ramp && (sampleCount > 0))
+    return t;
+  copyBiquadCoef(coefs, t, stages);
+  return NULL;
+}
+
+//one direct form 2 step (the form of the ESP-DSP kernel), shared by all the biquad cascades
+static inline float biquadStep(float x, float b0, float b1, float b2, float a1, float a2, float& s1, float& s2)
+{
+  float d0 = x - a1 * s1 - a2 * s2;
+  float y = b0 * d0 + b1 * s1 + b2 * s2;
+  s2 = s1;
+  s1 = d0;
+  return y;
+}
+void biquadFilter::reset()
+{
   for(int i=0;i<stages;i++)
   {
-    s[i].w[0]=0;
-    s[i].w[1]=0;
+    states[i * BIQUAD_STATE_STRIDE]=0;
+    states[i * BIQUAD_STATE_STRIDE + 1]=0;
   }
 }
 
-biquadFilter::~biquadFilter()
+void biquadFilter::reset(float dcInput)
+{
+  //the steady state of the latest coefficients
+  updateBiquadCoef(exchange, coefs, stages, 0);
+  float input = dcInput;
+  for(int s=0;s<stages;s++)
+  {
+    float* c = coefs + s * BIQUAD_COEF_STRIDE;
+    float* w = states + s * BIQUAD_STATE_STRIDE;
+    //w = input - a1.w - a2.w
+    w[0] = input / (1.0f + c[3] + c[4]);
+    w[1] = w[0];
+    input = (c[0] + c[1] + c[2]) * w[0];
+  }
+}
+
+//interpolated block: the coefficients move linearly to the targets over the block
+static void processInterpolated(const float* src, float* out, int sampleCount, float* c, const float* t, float* w)
+{
+  float k = 1.0f/(float)sampleCount;
+  float b0 = c[0], b1 = c[1], b2 = c[2], a1 = c[3], a2 = c[4];
+  float db0 = (t[0]-b0)*k, db1 = (t[1]-b1)*k, db2 = (t[2]-b2)*k, da1 = (t[3]-a1)*k, da2 = (t[4]-a2)*k;
+  float s1 = w[0], s2 = w[1];
+  for(int i=0;i<sampleCount;i++)
+  {
+    out[i] = biquadStep(src[i], b0, b1, b2, a1, a2, s1, s2);
+    b0 += db0;
+    b1 += db1;
+    b2 += db2;
+    a1 += da1;
+    a2 += da2;
+  }
+  w[0] = s1;
+  w[1] = s2;
+  for(int n=0;n<5;n++)
+    c[n] = t[n];
+}
+
+void biquadFilter::process(const float* in, float* out, int sampleCount)
+{
+  const float* targets = updateBiquadCoef(exchange, coefs, stages, sampleCount);
+  if(targets != NULL)
+  {
+    for(int s=0; s<stages; s++) 
+    {
+      //the first stage reads the input, the next ones work in place on the output
+      const float* src = (s == 0) ? in : out;
+      processInterpolated(src, out, sampleCount, coefs + s * BIQUAD_COEF_STRIDE, targets + s * BIQUAD_COEF_STRIDE, states + s * BIQUAD_STATE_STRIDE);
+    }
+    return;
+  }
+  
+#ifdef BIQUAD_USE_DSPS
+  for(int s=0; s<stages; s++) 
+  {
+    const float* src = (s == 0) ? in : out;
+    dsps_biquad_f32_ae32(src, out, sampleCount, coefs + s * BIQUAD_COEF_STRIDE, states + s * BIQUAD_STATE_STRIDE);
+  }
+#else
+  for(int i=0;i<sampleCount;i++)
+  {
+    float input = in[i];
+    for(int s=0; s<stages; s++) 
+    {
+      float* c = coefs + s * BIQUAD_COEF_STRIDE;
+      float* w = states + s * BIQUAD_STATE_STRIDE;
+      input = biquadStep(input, c[0], c[1], c[2], c[3], c[4], w[0], w[1]);
+    }
+    out[i] = input;
+  }
+#endif
+}
+
+float biquadFilter::process(float in)
+{
+  updateBiquadCoef(exchange, coefs, stages, 0);
+  float input = in;
+  for(int s=0; s<stages; s++) 
+  {
+    float* c = coefs + s * BIQUAD_COEF_STRIDE;
+    float* w = states + s * BIQUAD_STATE_STRIDE;
+    input = biquadStep(input, c[0], c[1], c[2], c[3], c[4], w[0], w[1]);
+  }
+  return input;
+}
+
+//######################################################################
+// LINKED (STEREO AND 4-LANE) BIQUAD FILTER
+// the direct form 2 step and the coefficient exchange of biquadFilter for all lanes, one coefficient load per stage and block
+
+biquadFilterLinked::biquadFilterLinked(int stageCount, int laneCount)
+{
+  stages = stageCount;
+  lanes = laneCount;
+  int length = stages * (4 * BIQUAD_COEF_STRIDE + 2 * lanes);
+  memory = new float[length + 4];
+  coefs = (float*)(((uintptr_t)memory + 15) & ~(uintptr_t)15);
+  exchange.init(coefs + stages * BIQUAD_COEF_STRIDE, stages);
+  states = coefs + 4 * stages * BIQUAD_COEF_STRIDE;
+  for(int i=0;i<length;i++)
+    coefs[i]=0;
+}
+
+biquadFilterLinked::~biquadFilterLinked()
+{
+  delete[] memory;
+}
+
+void biquadFilterLinked::setCoef(const float* coef)
+{
+  exchange.publish(coef, false);
+}
+
+void biquadFilterLinked::setCoef(const float* coef, bool interpolate)
+{
+  exchange.publish(coef, interpolate);
+}
+
+void biquadFilterLinked::reset()
+{
+  for(int i=0;i<stages * 2 * lanes;i++)
+    states[i]=0;
+}
+
+void biquadFilterLinked::reset(float dcInput)
+{
+  updateBiquadCoef(exchange, coefs, stages, 0);
+  float input = dcInput;
+  for(int s=0;s<stages;s++)
+  {
+    float* c = coefs + s * BIQUAD_COEF_STRIDE;
+    //w = input - a1.w - a2.w, as biquadFilter::reset()
+    float w0 = input / (1.0f + c[3] + c[4]);
+    for(int l=0;l<lanes;l++)
+    {
+      float* w = states + (s * lanes + l) * 2;
+      w[0] = w0;
+      w[1] = w0;
+    }
+    input = (c[0] + c[1] + c[2]) * w0;
+  }
+}
+
+//one biquad step of a lane
+#define LINKED_STEP(x, y, s1, s2) \
+  y = biquadStep(x, b0, b1, b2, a1, a2, s1, s2);
+
+//coefficient setup of a linked stage, with RAMP the coefficients move linearly to t over the block
+#define LINKED_COEF_SETUP \
+  float b0 = c[0], b1 = c[1], b2 = c[2], a1 = c[3], a2 = c[4]; \
+  float db0 = 0, db1 = 0, db2 = 0, da1 = 0, da2 = 0; \
+  if(RAMP) \
+  { \
+    float k = 1.0f/(float)sampleCount; \
+    db0 = (t[0]-b0)*k; db1 = (t[1]-b1)*k; db2 = (t[2]-b2)*k; da1 = (t[3]-a1)*k; da2 = (t[4]-a2)*k; \
+  }
+
+#define LINKED_COEF_STEP \
+  if(RAMP) \
+  { \
+    b0 += db0; b1 += db1; b2 += db2; a1 += da1; a2 += da2; \
+  }
+
+#define LINKED_COEF_END \
+  if(RAMP) \
+  { \
+    for(int k=0;k<5;k++) \
+      c[k] = t[k]; \
+  }
+
+//the lanes are written out so that the coefficients and all the states stay in registers
+template <bool RAMP>
+static void stereoStage(const float* const* src, float* const* dst, int sampleCount, int stride, float* c, const float* t, float* w)
+{
+  LINKED_COEF_SETUP
+  const float* x0 = src[0];
+  const float* x1 = src[1];
+  float* y0 = dst[0];
+  float* y1 = dst[1];
+  float s10 = w[0], s20 = w[1], s11 = w[2], s21 = w[3];
+  int n = sampleCount * stride;
+  for(int i=0;i<n;i+=stride)
+  {
+    float in0 = x0[i], in1 = x1[i];
+    float out0, out1;
+    LINKED_STEP(in0, out0, s10, s20)
+    LINKED_STEP(in1, out1, s11, s21)
+    y0[i] = out0;
+    y1[i] = out1;
+    LINKED_COEF_STEP
+  }
+  w[0] = s10; w[1] = s20; w[2] = s11; w[3] = s21;
+  LINKED_COEF_END
+}
+
+template <bool RAMP>
+static void quadStage(const float* const* src, float* const* dst, int sampleCount, int stride, float* c, const float* t, float* w)
+{
+  LINKED_COEF_SETUP
+  const float* x0 = src[0];
+  const float* x1 = src[1];
+  const float* x2 = src[2];
+  const float* x3 = src[3];
+  float* y0 = dst[0];
+  float* y1 = dst[1];
+  float* y2 = dst[2];
+  float* y3 = dst[3];
+  float s10 = w[0], s20 = w[1], s11 = w[2], s21 = w[3];
+  float s12 = w[4], s22 = w[5], s13 = w[6], s23 = w[7];
+  int n = sampleCount * stride;
+  for(int i=0;i<n;i+=stride)
+  {
+    float in0 = x0[i], in1 = x1[i], in2 = x2[i], in3 = x3[i];
+    float out0, out1, out2, out3;
+    LINKED_STEP(in0, out0, s10, s20)
+    LINKED_STEP(in1, out1, s11, s21)
+    LINKED_STEP(in2, out2, s12, s22)
+    LINKED_STEP(in3, out3, s13, s23)
+    y0[i] = out0;
+    y1[i] = out1;
+    y2[i] = out2;
+    y3[i] = out3;
+    LINKED_COEF_STEP
+  }
+  w[0] = s10; w[1] = s20; w[2] = s11; w[3] = s21;
+  w[4] = s12; w[5] = s22; w[6] = s13; w[7] = s23;
+  LINKED_COEF_END
+}
+
+void biquadFilterLinked::processLanes(const float* const* in, float* const* out, int sampleCount, int stride)
+{
+  if(sampleCount <= 0)
+    return;
+  const float* targets = updateBiquadCoef(exchange, coefs, stages, sampleCount);
+  bool ramp = (targets != NULL);
+  for(int s=0; s<stages; s++) 
+  {
+    //the first stage reads the input, the next ones work in place on the output
+    const float* const* src = (s == 0) ? in : out;
+    float* c = coefs + s * BIQUAD_COEF_STRIDE;
+    const float* t = ramp ? targets + s * BIQUAD_COEF_STRIDE : NULL;
+    float* w = states + s * 2 * lanes;
+    if(lanes == 4)
+    {
+      if(ramp) quadStage<true>(src, out, sampleCount, stride, c, t, w);
+      else quadStage<false>(src, out, sampleCount, stride, c, t, w);
+    }
+    else
+    {
+      if(ramp) stereoStage<true>(src, out, sampleCount, stride, c, t, w);
+      else stereoStage<false>(src, out, sampleCount, stride, c, t, w);
+    }
+  }
+}
+
+biquadFilterStereo::biquadFilterStereo(int stageCount) : biquadFilterLinked(stageCount, 2)
+{
+}
+
+void biquadFilterStereo::process(const float* inL, const float* inR, float* outL, float* outR, int sampleCount)
+{
+  const float* in[2] = {inL, inR};
+  float* out[2] = {outL, outR};
+  processLanes(in, out, sampleCount, 1);
+}
+
+void biquadFilterStereo::process(const float* in, float* out, int frameCount)
+{
+  const float* src[2] = {in, in + 1};
+  float* dst[2] = {out, out + 1};
+  processLanes(src, dst, frameCount, 2);
+}
+
+biquadFilterQuad::biquadFilterQuad(int stageCount) : biquadFilterLinked(stageCount, 4)
+{
+}
+
+void biquadFilterQuad::process(const float* const* in, float* const* out, int sampleCount)
+{
+  processLanes(in, out, sampleCount, 1);
+}
+
+//######################################################################
+// FAST SINE AND COSINE
+#define FAST_PI		3.14159265358979f
+#define FAST_TWOPI	6.28318530717959f
+
+//odd polynomial of sin(x) for -pi/2 <= x <= pi/2 (taylor series up to x^11)
+static inline float sinPoly(float x)
+{
+  float x2 = x * x;
+  return x * (1.0f + x2 * (-1.6666667e-1f + x2 * (8.3333333e-3f + x2 * (-1.9841270e-4f + x2 * (2.7557319e-6f + x2 * -2.5052108e-8f)))));
+}
+
+float fastSin(float x)
+{
+  //reduce to -pi .. pi, then fold to -pi/2 .. pi/2
+  x = x - FAST_TWOPI * floorf((x + FAST_PI) * (1.0f/FAST_TWOPI));
+  if(x > 0.5f*FAST_PI) x = FAST_PI - x;
+  else if(x < -0.5f*FAST_PI) x = -FAST_PI - x;
+  return sinPoly(x);
+}
+
+float fastCos(float x)
+{
+  return fastSin(x + 0.5f*FAST_PI);
+}
+
+float fastTan(float x)
 {
-  biquadState* sp = (biquadState*) states;
-  delete[] states;
+  //[7/6] pade approximant
+  float x2 = x * x;
+  float n = x * (135135.0f + x2 * (-17325.0f + x2 * (378.0f - x2)));
+  float d = 135135.0f + x2 * (-62370.0f + x2 * (3150.0f - 28.0f * x2));
+  return n / d;
 }
 
-void biquadFilter::setCoef(const float* coef)
+//######################################################################
+// BIQUAD FILTER DESIGN
+// RBJ audio eq cookbook, the angle functions use the half angle for the precision at low frequencies
+
+void designBiquad(float* coef, FILTER_TYPE type, float freq, float q, float gainDb, float sampleRate)
+{
+  if(sampleRate <= 0) sampleRate = SAMPLE_RATE;
+  float w0 = FAST_TWOPI * freq / sampleRate;
+  float sh = fastSin(0.5f * w0);
+  float ch = fastCos(0.5f * w0);
+  float sinw = 2.0f * sh * ch;
+  float cosw = 1.0f - 2.0f * sh * sh;
+  float alpha = sinw / (2.0f * q);
+  float A = 1;
+  if((type == FT_PEAKING) || (type == FT_LOWSHELF) || (type == FT_HIGHSHELF))
+    A = powf(10.0f, gainDb / 40.0f);
+  
+  float b0, b1, b2, a0, a1, a2;
+  switch(type)
+  {
+    case FT_LOWPASS:
+    {
+      b1 = 1.0f - cosw;
+      b0 = 0.5f * b1;
+      b2 = b0;
+      a0 = 1.0f + alpha;
+      a1 = -2.0f * cosw;
+      a2 = 1.0f - alpha;
+      break;
+    }
+    case FT_HIGHPASS:
+    {
+      b1 = -(1.0f + cosw);
+      b0 = -0.5f * b1;
+      b2 = b0;
+      a0 = 1.0f + alpha;
+      a1 = -2.0f * cosw;
+      a2 = 1.0f - alpha;
+      break;
+    }
+    case FT_BANDPASS:
+    {
+      b0 = alpha;
+      b1 = 0;
+      b2 = -alpha;
+      a0 = 1.0f + alpha;
+      a1 = -2.0f * cosw;
+      a2 = 1.0f - alpha;
+      break;
+    }
+    case FT_NOTCH:
+    {
+      b0 = 1;
+      b1 = -2.0f * cosw;
+      b2 = 1;
+      a0 = 1.0f + alpha;
+      a1 = -2.0f * cosw;
+      a2 = 1.0f - alpha;
+      break;
+    }
+    case FT_PEAKING:
+    {
+      b0 = 1.0f + alpha * A;
+      b1 = -2.0f * cosw;
+      b2 = 1.0f - alpha * A;
+      a0 = 1.0f + alpha / A;
+      a1 = -2.0f * cosw;
+      a2 = 1.0f - alpha / A;
+      break;
+    }
+    case FT_LOWSHELF:
+    {
+      float sa = 2.0f * sqrtf(A) * alpha;
+      b0 = A * ((A + 1.0f) - (A - 1.0f) * cosw + sa);
+      b1 = 2.0f * A * ((A - 1.0f) - (A + 1.0f) * cosw);
+      b2 = A * ((A + 1.0f) - (A - 1.0f) * cosw - sa);
+      a0 = (A + 1.0f) + (A - 1.0f) * cosw + sa;
+      a1 = -2.0f * ((A - 1.0f) + (A + 1.0f) * cosw);
+      a2 = (A + 1.0f) + (A - 1.0f) * cosw - sa;
+      break;
+    }
+    default: //FT_HIGHSHELF
+    {
+      float sa = 2.0f * sqrtf(A) * alpha;
+      b0 = A * ((A + 1.0f) + (A - 1.0f) * cosw + sa);
+      b1 = -2.0f * A * ((A - 1.0f) + (A + 1.0f) * cosw);
+      b2 = A * ((A + 1.0f) + (A - 1.0f) * cosw - sa);
+      a0 = (A + 1.0f) - (A - 1.0f) * cosw + sa;
+      a1 = 2.0f * ((A - 1.0f) - (A + 1.0f) * cosw);
+      a2 = (A + 1.0f) - (A - 1.0f) * cosw - sa;
+      break;
+    }
+  }
+  
+  //normalize, the feedback coefficients are negated for the biquadFilter convention
+  float k = 1.0f / a0;
+  coef[0] = b0 * k;
+  coef[1] = b1 * k;
+  coef[2] = b2 * k;
+  coef[3] = -a1 * k;
+  coef[4] = -a2 * k;
+}
+
+//first order bilinear low-pass or high-pass as a biquad stage (b2 = a2 = 0)
+static void designFirstOrder(float* coef, bool highPass, float freq, float sampleRate)
+{
+  float w = 0.5f * FAST_TWOPI * freq / sampleRate;
+  float t = fastSin(w) / fastCos(w);
+  float k = 1.0f / (1.0f + t);
+  coef[0] = highPass ? k : t * k;
+  coef[1] = highPass ? -k : t * k;
+  coef[2] = 0;
+  coef[3] = (1.0f - t) * k;
+  coef[4] = 0;
+}
+
+void designButterworth(float* coef, int stageCount, bool highPass, float freq, float sampleRate)
+{
+  if(sampleRate <= 0) sampleRate = SAMPLE_RATE;
+  //pole pair k of the order 2n butterworth: q = 1/(2.cos((2k+1).pi/4n))
+  for(int k=0;k<stageCount;k++)
+  {
+    float q = 0.5f / fastCos((float)(2*k+1) * FAST_PI / (float)(4*stageCount));
+    designBiquad(coef + 5*k, highPass ? FT_HIGHPASS : FT_LOWPASS, freq, q, 0, sampleRate);
+  }
+}
+
+void designLinkwitzRiley(float* coef, int stageCount, bool highPass, float freq, float sampleRate)
+{
+  if(sampleRate <= 0) sampleRate = SAMPLE_RATE;
+  //two cascaded butterworth filters of order n = stageCount,
+  //pole pair k: q = 1/(2.cos((2k+1).pi/2n)) for even n, 1/(2.cos((k+1).pi/n)) for odd n
+  int pairs = stageCount / 2;
+  for(int k=0;k<pairs;k++)
+  {
+    float angle = (stageCount & 1) ? (float)(k+1) * FAST_PI / (float)stageCount : (float)(2*k+1) * FAST_PI / (float)(2*stageCount);
+    float q = 0.5f / fastCos(angle);
+    designBiquad(coef + 10*k, highPass ? FT_HIGHPASS : FT_LOWPASS, freq, q, 0, sampleRate);
+    for(int n=0;n<5;n++)
+      coef[10*k + 5 + n] = coef[10*k + n];
+  }
+  
+  //odd order butterworth: its two first order sections make one more stage
+  if(stageCount & 1)
+  {
+    float first[5];
+    float* c = coef + 10*pairs;
+    designFirstOrder(first, highPass, freq, sampleRate);
+    //(b0 + b1.z)^2 / (1 - a1.z)^2
+    c[0] = first[0] * first[0];
+    c[1] = 2.0f * first[0] * first[1];
+    c[2] = first[1] * first[1];
+    c[3] = 2.0f * first[3];
+    c[4] = -first[3] * first[3];
+    
+    //the low-pass and high-pass of order 2 x odd are 180 degrees apart at every frequency,
+    //invert the high-pass so that they sum flat instead of cancelling at the crossover
+    if(highPass)
+    {
+      for(int n=0;n<3;n++)
+        coef[n] = -coef[n];
+    }
+  }
+}
+
+//######################################################################
+// FRACTIONAL DELAY
+fractionalDelay::fractionalDelay()
+{
+	bufflength=0;
+	mask=0;
+	writeIndex=0;
+	buffer = NULL;
+	sampleCountPerMs = (float)SAMPLE_RATE/1000.0f;
+	maxdelay = 0;
+	maxDelaySamples = 0;
+	interpolation = DI_LINEAR;
+	allpassState = 0;
+}
+
+bool fractionalDelay::init(float maxDelayInMs)
+{
+	maxdelay = maxDelayInMs;
+	return initSamples((int)ceilf(maxDelayInMs * sampleCountPerMs));
+}
+
+bool fractionalDelay::initSamples(int maxDelayInSamples)
+{
+	if(buffer!=NULL)
+		return false;
+	
+	maxDelaySamples = (float)maxDelayInSamples;
+	maxdelay = maxDelaySamples / sampleCountPerMs;
+	
+	//room for the interpolation points and the block reads behind the write position
+	int needed = maxDelayInSamples + 3 + MAX_AUDIO_BLOCK;
+	bufflength = 1;
+	while(bufflength < needed)
+		bufflength <<= 1;
+	mask = bufflength - 1;
+	buffer = new float[bufflength];
+	
+	if(buffer!=NULL)
+	{
+		clear();
+		return true;
+	}
+	else return false;
+}
+
+fractionalDelay::~fractionalDelay()
+{
+	if(buffer != NULL)
+		delete[] buffer;
+}
+
+void fractionalDelay::setInterpolation(DELAY_INTERPOLATION mode)
+{
+	interpolation = mode;
+	allpassState = 0;
+}
+
+float fractionalDelay::getSampleCountPerMs()
+{
+	return sampleCountPerMs;
+}
+
+void fractionalDelay::clear()
+{
+	for(int i=0;i<bufflength;i++)
+		buffer[i]=0;
+	allpassState = 0;
+}
+
+void fractionalDelay::write(float sample)
+{
+	writeIndex = (writeIndex + 1) & mask;
+	buffer[writeIndex]=sample;
+}
+
+void fractionalDelay::write(const float* in, int sampleCount)
+{
+	//copy in up to two runs, split at the end of the ring buffer
+	int start = (writeIndex + 1) & mask;
+	int first = bufflength - start;
+	if(first > sampleCount)
+		first = sampleCount;
+	for(int i=0;i<first;i++)
+		buffer[start + i] = in[i];
+	for(int i=first;i<sampleCount;i++)
+		buffer[i - first] = in[i];
+	writeIndex = (writeIndex + sampleCount) & mask;
+}
+
+float fractionalDelay::read(float delayInMs)
+{
+	return readSamples(delayInMs * sampleCountPerMs);
+}
+
+//delay clamping and the interpolation kernels, pos is the write position of the output sample,
+//x0 is the sample at the integer delay, x1 the one before it (one sample older)
+static inline float clampDelay(float d, float minDelay, float maxDelay)
+{
+	if(d < minDelay) return minDelay;
+	if(d > maxDelay) return maxDelay;
+	return d;
+}
+
+static inline float linearRead(const float* buffer, int mask, int pos, float d)
+{
+	int n = (int)d;
+	float frac = d - (float)n;
+	int i0 = (pos - n) & mask;
+	float x0 = buffer[i0];
+	float x1 = buffer[(i0 - 1) & mask];
+	return x0 + frac * (x1 - x0);
+}
+
+static inline float hermiteRead(const float* buffer, int mask, int pos, float d)
+{
+	int n = (int)d;
+	float frac = d - (float)n;
+	int i0 = (pos - n) & mask;
+	float xm1 = buffer[(i0 + 1) & mask];
+	float x0 = buffer[i0];
+	float x1 = buffer[(i0 - 1) & mask];
+	float x2 = buffer[(i0 - 2) & mask];
+	float c1 = 0.5f * (x1 - xm1);
+	float c2 = xm1 - 2.5f * x0 + 2.0f * x1 - 0.5f * x2;
+	float c3 = 0.5f * (x2 - xm1) + 1.5f * (x0 - x1);
+	return ((c3 * frac + c2) * frac + c1) * frac + x0;
+}
+
+//y = eta.(x0 - y1) + x1, eta = (1 - frac)/(1 + frac), the fraction is kept at 0.1 or more
+//(one more sample of integer delay when possible) to keep the pole away from z = -1
+static inline float allpassRead(const float* buffer, int mask, int pos, float d, float& state)
+{
+	int n = (int)d;
+	float frac = d - (float)n;
+	if((frac < 0.1f) && (n > 0))
+	{
+		n--;
+		frac += 1.0f;
+	}
+	float eta = (1.0f - frac) / (1.0f + frac);
+	int i0 = (pos - n) & mask;
+	float x0 = buffer[i0];
+	float x1 = buffer[(i0 - 1) & mask];
+	state = eta * (x0 - state) + x1;
+	return state;
+}
+
+float fractionalDelay::readSamples(float delayInSamples)
+{
+	switch(interpolation)
+	{
+		case DI_NONE:
+			return buffer[(writeIndex - (int)clampDelay(delayInSamples, 0, maxDelaySamples)) & mask];
+		case DI_HERMITE:
+			return hermiteRead(buffer, mask, writeIndex, clampDelay(delayInSamples, 1.0f, maxDelaySamples));
+		case DI_ALLPASS:
+			return allpassRead(buffer, mask, writeIndex, clampDelay(delayInSamples, 0, maxDelaySamples), allpassState);
+		default:
+			return linearRead(buffer, mask, writeIndex, clampDelay(delayInSamples, 0, maxDelaySamples));
+	}
+}
+
+void fractionalDelay::read(float* out, int sampleCount, float delayInSamples, const float* modulation)
+{
+	//write position of the first sample of the last written block
+	int pos = writeIndex - sampleCount + 1;
+	float minDelay = (interpolation == DI_HERMITE) ? 1.0f : 0.0f;
+	float maxDelay = maxDelaySamples;
+	
+	//constant delay: the delay and its clamping are computed once
+	if(modulation == NULL)
+	{
+		float d = clampDelay(delayInSamples, minDelay, maxDelay);
+		switch(interpolation)
+		{
+			case DI_NONE:
+			{
+				int n = (int)d;
+				for(int i=0;i<sampleCount;i++)
+					out[i] = buffer[(pos + i - n) & mask];
+				break;
+			}
+			case DI_HERMITE:
+			{
+				for(int i=0;i<sampleCount;i++)
+					out[i] = hermiteRead(buffer, mask, pos + i, d);
+				break;
+			}
+			case DI_ALLPASS:
+			{
+				float state = allpassState;
+				for(int i=0;i<sampleCount;i++)
+					out[i] = allpassRead(buffer, mask, pos + i, d, state);
+				allpassState = state;
+				break;
+			}
+			default:
+			{
+				for(int i=0;i<sampleCount;i++)
+					out[i] = linearRead(buffer, mask, pos + i, d);
+				break;
+			}
+		}
+		return;
+	}
+	
+	switch(interpolation)
+	{
+		case DI_NONE:
+		{
+			for(int i=0;i<sampleCount;i++)
+				out[i] = buffer[(pos + i - (int)clampDelay(delayInSamples + modulation[i], minDelay, maxDelay)) & mask];
+			break;
+		}
+		case DI_HERMITE:
+		{
+			for(int i=0;i<sampleCount;i++)
+				out[i] = hermiteRead(buffer, mask, pos + i, clampDelay(delayInSamples + modulation[i], minDelay, maxDelay));
+			break;
+		}
+		case DI_ALLPASS:
+		{
+			float state = allpassState;
+			for(int i=0;i<sampleCount;i++)
+				out[i] = allpassRead(buffer, mask, pos + i, clampDelay(delayInSamples + modulation[i], minDelay, maxDelay), state);
+			allpassState = state;
+			break;
+		}
+		default:
+		{
+			for(int i=0;i<sampleCount;i++)
+				out[i] = linearRead(buffer, mask, pos + i, clampDelay(delayInSamples + modulation[i], minDelay, maxDelay));
+			break;
+		}
+	}
+}
+
+//######################################################################
+// MULTI-TAP DELAY READER
+multiTapDelay::multiTapDelay(int maxTapCount)
+{
+	maxTaps = maxTapCount;
+	tapCount = maxTapCount;
+	taps = new DELAYTAP[maxTaps];
+	for(int i=0;i<maxTaps;i++)
+		setTap(i, 0, 0);
+}
+
+multiTapDelay::~multiTapDelay()
+{
+	delete[] taps;
+}
+
+void multiTapDelay::setTapCount(int count)
+{
+	if(count < 0) count = 0;
+	if(count > maxTaps) count = maxTaps;
+	tapCount = count;
+}
+
+int multiTapDelay::getTapCount()
+{
+	return tapCount;
+}
+
+void multiTapDelay::setTap(int index, float delayInSamples, float gain, const float* modulation, float depth)
+{
+	if((index < 0) || (index >= maxTaps))
+		return;
+	taps[index].delayInSamples = delayInSamples;
+	taps[index].gain = gain;
+	taps[index].modulation = modulation;
+	taps[index].depth = depth;
+}
+
+void multiTapDelay::setTapDelay(int index, float delayInSamples)
+{
+	if((index >= 0) && (index < maxTaps))
+		taps[index].delayInSamples = delayInSamples;
+}
+
+void multiTapDelay::setTapGain(int index, float gain)
+{
+	if((index >= 0) && (index < maxTaps))
+		taps[index].gain = gain;
+}
+
+//one tap added to out, the write position of the block and the clamping limits are computed
+//once by the caller, a fixed tap also resolves its integer delay and fraction once
+static void readTap(const DELAYTAP* tap, const float* buffer, int mask, int pos,
+	float minDelay, float maxDelay, bool hermite, float* out, int sampleCount)
+{
+	float gain = tap->gain;
+	const float* mod = tap->modulation;
+	if(mod == NULL)
+	{
+		float d = clampDelay(tap->delayInSamples, minDelay, maxDelay);
+		int n = (int)d;
+		float frac = d - (float)n;
+		int start = pos - n;
+		if(hermite)
+		{
+			//the integer delay is already in start, the kernel only sees the fraction
+			for(int i=0;i<sampleCount;i++)
+				out[i] += gain * hermiteRead(buffer, mask, start + i, frac);
+		}
+		else
+		{
+			//x0 + frac.(x1 - x0) with the gain folded in
+			float g0 = gain * (1.0f - frac);
+			float g1 = gain * frac;
+			for(int i=0;i<sampleCount;i++)
+			{
+				int i0 = (start + i) & mask;
+				out[i] += g0 * buffer[i0] + g1 * buffer[(i0 - 1) & mask];
+			}
+		}
+		return;
+	}
+	
+	float delay = tap->delayInSamples;
+	float depth = tap->depth;
+	for(int i=0;i<sampleCount;i++)
+	{
+		float d = clampDelay(delay + depth * mod[i], minDelay, maxDelay);
+		out[i] += gain * (hermite ? hermiteRead(buffer, mask, pos + i, d) : linearRead(buffer, mask, pos + i, d));
+	}
+}
+
+void multiTapDelay::read(fractionalDelay& line, float* out, int sampleCount)
+{
+	for(int i=0;i<sampleCount;i++)
+		out[i] = 0;
+	int pos = line.writeIndex - sampleCount + 1;
+	bool hermite = (line.interpolation == DI_HERMITE);
+	float minDelay = hermite ? 1.0f : 0.0f;
+	for(int t=0;t<tapCount;t++)
+		readTap(&taps[t], line.buffer, line.mask, pos, minDelay, line.maxDelaySamples, hermite, out, sampleCount);
+}
+
+void multiTapDelay::readTaps(fractionalDelay& line, float* const* tapOut, int sampleCount)
+{
+	int pos = line.writeIndex - sampleCount + 1;
+	bool hermite = (line.interpolation == DI_HERMITE);
+	float minDelay = hermite ? 1.0f : 0.0f;
+	for(int t=0;t<tapCount;t++)
+	{
+		for(int i=0;i<sampleCount;i++)
+			tapOut[t][i] = 0;
+		readTap(&taps[t], line.buffer, line.mask, pos, minDelay, line.maxDelaySamples, hermite, tapOut[t], sampleCount);
+	}
+}
+
+//######################################################################
+// WAVESHAPER
+waveShaper::waveShaper()
+{
+	//initialize the transfer function table with default function: 2/(1+exp(-6x))-1 = tanh(3x), x = -1 .. 1,
+	//copied from the compile-time table
+	memcpy(transferFunctionTable, sharedTable<tanhShape<3>, float, 255>::table.data, sizeof(transferFunctionTable));
+}
+
+float waveShaper::process(float in)
+{
+	float val = (in+1.0f)*127.5f;
+	if(val<0.0f) val = 0.0f;
+	if(val>255.0f) val=255.0f;
+	return lookupLinear(val,transferFunctionTable);
+}
+
+void waveShaper::process(float* in, float* out, int sampleCount)
+{
+	for(int i=0;i<sampleCount;i++)
+	{
+		float val = (in[i]+1.0f)*127.5f;
+		if(val<0.0f) val = 0.0f;
+		if(val>255.0f) val=255.0f;
+		out[i]= lookupLinear(val,transferFunctionTable);
+	}
+}
+
+//######################################################################
+// WAVESHAPER WITH ANTIDERIVATIVE ANTI-ALIASING
+// below this input step the ADAA quotient loses its precision in float, the transfer function
+// at the midpoint is used instead (the same value for a smooth function)
+#define ADAA_MIN_STEP	1.0e-3f
+
+static float defaultTransferFunction(float x)
+{
+	return tanhf(3.0f * x);
+}
+
+waveShaperADAA::waveShaperADAA(int tableSize)
+{
+	if(tableSize < 16) tableSize = 16;
+	size = tableSize;
+	scale = 0.5f * (float)size;
+	step = 2.0f / (float)size;
+	memory = new float[2 * (size + 2)];
+	table = memory;
+	integral = memory + size + 2;
+	antialiasing = true;
+	setTransferFunction(defaultTransferFunction);
+}
+
+waveShaperADAA::~waveShaperADAA()
+{
+	delete[] memory;
+}
+
+void waveShaperADAA::setTransferFunction(const float* transferTable, int length)
+{
+	float k = (float)(length - 1) / (float)size;
+	for(int i=0;i<=size;i++)
+	{
+		float pos = (float)i * k;
+		int index = (int)pos;
+		if(index > length - 2) index = length - 2;
+		float frac = pos - (float)index;
+		table[i] = transferTable[index] + frac * (transferTable[index + 1] - transferTable[index]);
+	}
+	buildIntegral();
+}
+
+void waveShaperADAA::setTransferFunction(float (*transferFunction)(float x))
+{
+	for(int i=0;i<=size;i++)
+		table[i] = transferFunction((float)i * step - 1.0f);
+	buildIntegral();
+}
+
+void waveShaperADAA::buildIntegral()
+{
+	//the guard point continues the curve flat, the integral is exact for the linear interpolation of the table
+	table[size + 1] = table[size];
+	integral[0] = 0;
+	for(int i=1;i<=size+1;i++)
+		integral[i] = integral[i-1] + 0.5f * step * (table[i-1] + table[i]);
+	//from x = 0 instead of -1: smaller values, more precision left for the difference of two of them
+	float offset = integral[size / 2];
+	for(int i=0;i<=size+1;i++)
+		integral[i] -= offset;
+	reset();
+}
+
+void waveShaperADAA::setAntialiasing(bool enable)
+{
+	antialiasing = enable;
+	reset();
+}
+
+void waveShaperADAA::reset()
+{
+	x1 = 0;
+	F1 = antiderivative(0);
+}
+
+//the clamped position never exceeds size, so index + 1 is at most the guard point
+inline float waveShaperADAA::transfer(float x)
+{
+	float xc = fminf(fmaxf(x, -1.0f), 1.0f);
+	float pos = (xc + 1.0f) * scale;
+	int index = (int)pos;
+	float frac = pos - (float)index;
+	return table[index] + frac * (table[index + 1] - table[index]);
+}
+
+//integral of the interpolated table up to x, beyond -1 .. 1 it grows with the end values
+inline float waveShaperADAA::antiderivative(float x)
+{
+	float xc = fminf(fmaxf(x, -1.0f), 1.0f);
+	float pos = (xc + 1.0f) * scale;
+	int index = (int)pos;
+	float frac = pos - (float)index;
+	float f0 = table[index];
+	float slope = table[index + 1] - f0;
+	float fc = f0 + frac * slope;
+	return integral[index] + step * frac * (f0 + 0.5f * frac * slope) + fc * (x - xc);
+}
+
+float waveShaperADAA::process(float in)
+{
+	if(!antialiasing)
+		return transfer(in);
+	float F = antiderivative(in);
+	float dx = in - x1;
+	float y;
+	if(fabsf(dx) < ADAA_MIN_STEP)
+		y = transfer(0.5f * (in + x1));
+	else y = (F - F1) / dx;
+	x1 = in;
+	F1 = F;
+	return y;
+}
+
+void waveShaperADAA::process(const float* in, float* out, int sampleCount)
+{
+	if(!antialiasing)
+	{
+		for(int i=0;i<sampleCount;i++)
+			out[i] = transfer(in[i]);
+		return;
+	}
+	float xp = x1;
+	float Fp = F1;
+	for(int i=0;i<sampleCount;i++)
+	{
+		float x = in[i];
+		float F = antiderivative(x);
+		float dx = x - xp;
+		out[i] = (fabsf(dx) < ADAA_MIN_STEP) ? transfer(0.5f * (x + xp)) : (F - Fp) / dx;
+		xp = x;
+		Fp = F;
+	}
+	x1 = xp;
+	F1 = Fp;
+}
+
+//######################################################################
+// STATE VARIABLE FILTER
+// per sample: v3 = x - ic2, v1 = a1.ic1 + a2.v3, v2 = ic2 + a2.ic1 + a3.v3, ic1 = 2.v1 - ic1, ic2 = 2.v2 - ic2,
+// low = v2, band = v1, high = x - k.v1 - v2, with g = tan(pi.fc/fs), a1 = 1/(1 + g.(g + k)), a2 = g.a1, a3 = g.a2
+#define SVF_MIN_CUTOFF	10.0f
+#define SVF_MAX_CUTOFF	(0.49f*(float)SAMPLE_RATE)
+
+//the coefficients from the cutoff, g = n/d (fastTan) so that a1, a2 and a3 share one division
+static inline void svfCoef(float freq, float k, float& a1, float& a2, float& a3)
 {
-  biquadState* sp = (biquadState*) states;
-  for(int i=0;i<stages;i++)
-  {
-    for(int n=0;n<5;n++)
-      sp[i].coef[n]=coef[(5*i)+n];
-  }
+	freq = fminf(fmaxf(freq, SVF_MIN_CUTOFF), SVF_MAX_CUTOFF);
+	float x = freq * (FAST_PI/(float)SAMPLE_RATE);
+	float x2 = x * x;
+	float n = x * (135135.0f + x2 * (-17325.0f + x2 * (378.0f - x2)));
+	float d = 135135.0f + x2 * (-62370.0f + x2 * (3150.0f - 28.0f * x2));
+	float r = 1.0f / (d * d + n * (n + k * d));
+	a1 = d * d * r;
+	a2 = n * d * r;
+	a3 = n * n * r;
 }
 
-void biquadFilter::reset()
+stateVariableFilter::stateVariableFilter()
 {
-	biquadState* sp = (biquadState*) states;
-    for(int i=0;i<stages;i++)
-    {
-      sp[i].w[0]=0;
-      sp[i].w[1]=0;
-    }
+	k = 1.41421356f;
+	cutoff = 1000;
+	setMode(FT_LOWPASS);
+	reset();
+	updateCoef();
 }
 
-void biquadFilter::process(const float* in, float* out, int sampleCount)
+void stateVariableFilter::updateCoef()
 {
-  biquadState* sp = (biquadState*) states;
-  for(int i=0;i<sampleCount;i++)
-  {
-    float input = in[i];
-    for(int s=0; s<stages; s++) 
-    {
-      float temp = input + sp[s].coef[3] * sp[s].w[0] + sp[s].coef[4]*sp[s].w[1];
-      input = temp * sp[s].coef[0] + sp[s].coef[1] * sp[s].w[0] + sp[s].coef[2]*sp[s].w[1];
-      sp[s].w[1]=sp[s].w[0];
-      sp[s].w[0]=temp;
-    }
-    out[i]=input;
-  }
+	svfCoef(cutoff, k, a1, a2, a3);
 }
 
-float biquadFilter::process(float in)
+void stateVariableFilter::setCutOff(float freq)
 {
-	biquadState* sp = (biquadState*) states;
-	float input = in;
-    for(int s=0; s<stages; s++) 
-    {
-      float temp = input + sp[s].coef[3] * sp[s].w[0] + sp[s].coef[4]*sp[s].w[1];
-      input = temp * sp[s].coef[0] + sp[s].coef[1] * sp[s].w[0] + sp[s].coef[2]*sp[s].w[1];
-      sp[s].w[1]=sp[s].w[0];
-      sp[s].w[0]=temp;
-    }
-    return input;
+	cutoff = freq;
+	updateCoef();
 }
 
-//######################################################################
-// FRACTIONAL DELAY
-fractionalDelay::fractionalDelay()
+void stateVariableFilter::setQ(float q)
 {
-	bufflength=0;
-	writeIndex=0;
-	buffer = NULL;
+	if(q < 0.5f) q = 0.5f;
+	if(q > 20.0f) q = 20.0f;
+	k = 1.0f / q;
+	setMode(mode); //the band-pass, high-pass and notch mixes use k
+	updateCoef();
 }
 
-bool fractionalDelay::init(float maxDelayInMs)
+void stateVariableFilter::setMode(FILTER_TYPE filterMode)
 {
-	if(buffer!=NULL)
-		return false;
-		
-	maxdelay = maxDelayInMs;
-	sampleCountPerMs = SAMPLE_RATE/1000;
-	bufflength = ceilf(maxDelayInMs * sampleCountPerMs)+1;
-	buffer = new float[bufflength];
-	
-	if(buffer!=NULL)
+	mode = filterMode;
+	//output = m0.x + m1.band + m2.low
+	switch(mode)
 	{
-		for(int i=0;i<bufflength;i++)
-			buffer[i]=0;
-		return true;
+		case FT_HIGHPASS: m0 = 1; m1 = -k; m2 = -1; break;
+		case FT_BANDPASS: m0 = 0; m1 = k; m2 = 0; break;
+		case FT_NOTCH: m0 = 1; m1 = -k; m2 = 0; break;
+		default: m0 = 0; m1 = 0; m2 = 1; break;
 	}
-	else return false;
 }
 
-fractionalDelay::~fractionalDelay()
+void stateVariableFilter::reset()
 {
-	if(buffer != NULL)
-		delete[] buffer;
+	ic1[0] = ic1[1] = 0;
+	ic2[0] = ic2[1] = 0;
 }
 
-void fractionalDelay::write(float sample)
+float stateVariableFilter::process(float in)
 {
-	writeIndex++;
-	if(writeIndex>=bufflength)
-		writeIndex=0;
-	buffer[writeIndex]=sample;
+	float v3 = in - ic2[0];
+	float v1 = a1 * ic1[0] + a2 * v3;
+	float v2 = ic2[0] + a2 * ic1[0] + a3 * v3;
+	ic1[0] = 2.0f * v1 - ic1[0];
+	ic2[0] = 2.0f * v2 - ic2[0];
+	return m0 * in + m1 * v1 + m2 * v2;
 }
 
-float fractionalDelay::read(float delayInMs)
+void stateVariableFilter::process(const float* in, float* out, int sampleCount)
 {
-	float indexpos = (float)writeIndex - (sampleCountPerMs * delayInMs);
-	if(indexpos < 0)
-		indexpos = (float)bufflength + indexpos;
-		
-	int index0= (int) indexpos;
-	float frac = indexpos - (float) index0;
-	int index1 = index0 + 1;
-	if(index1==bufflength)
-		index1=0;
-	//linear interpolate at fractional point
-	return buffer[index0] + frac * (buffer[index1]-buffer[index0]);
+	float s1 = ic1[0], s2 = ic2[0];
+	for(int i=0;i<sampleCount;i++)
+	{
+		float x = in[i];
+		float v3 = x - s2;
+		float v1 = a1 * s1 + a2 * v3;
+		float v2 = s2 + a2 * s1 + a3 * v3;
+		s1 = 2.0f * v1 - s1;
+		s2 = 2.0f * v2 - s2;
+		out[i] = m0 * x + m1 * v1 + m2 * v2;
+	}
+	ic1[0] = s1;
+	ic2[0] = s2;
 }
 
-//######################################################################
-// WAVESHAPER
-waveShaper::waveShaper()
+void stateVariableFilter::process(const float* in, float* out, const float* cutoffs, int sampleCount)
 {
-	//initialize the transfer function table with default function
-	for(int i=0;i<256;i++)
+	float s1 = ic1[0], s2 = ic2[0];
+	float c1, c2, c3;
+	for(int i=0;i<sampleCount;i++)
 	{
-		float x = ((float)i-127.5f)/127.5f;
-		transferFunctionTable[i]=2.0f/(1+expf(-6.0f*x))-1.0f;
+		svfCoef(cutoffs[i], k, c1, c2, c3);
+		float x = in[i];
+		float v3 = x - s2;
+		float v1 = c1 * s1 + c2 * v3;
+		float v2 = s2 + c2 * s1 + c3 * v3;
+		s1 = 2.0f * v1 - s1;
+		s2 = 2.0f * v2 - s2;
+		out[i] = m0 * x + m1 * v1 + m2 * v2;
 	}
+	ic1[0] = s1;
+	ic2[0] = s2;
 }
 
-float waveShaper::process(float in)
+void stateVariableFilter::processAll(const float* in, float* lowOut, float* bandOut, float* highOut, float* notchOut, int sampleCount)
 {
-	float val = (in+1.0f)*127.5f;
-	if(val<0.0f) val = 0.0f;
-	if(val>255.0f) val=255.0f;
-	return lookupLinear(val,transferFunctionTable);
+	float s1 = ic1[0], s2 = ic2[0];
+	for(int i=0;i<sampleCount;i++)
+	{
+		float x = in[i];
+		float v3 = x - s2;
+		float v1 = a1 * s1 + a2 * v3;
+		float v2 = s2 + a2 * s1 + a3 * v3;
+		s1 = 2.0f * v1 - s1;
+		s2 = 2.0f * v2 - s2;
+		float notch = x - k * v1;
+		lowOut[i] = v2;
+		bandOut[i] = v1;
+		highOut[i] = notch - v2;
+		notchOut[i] = notch;
+	}
+	ic1[0] = s1;
+	ic2[0] = s2;
 }
 
-void waveShaper::process(float* in, float* out, int sampleCount)
+void stateVariableFilter::process(const float* inL, const float* inR, float* outL, float* outR, int sampleCount)
 {
+	float s1l = ic1[0], s2l = ic2[0], s1r = ic1[1], s2r = ic2[1];
 	for(int i=0;i<sampleCount;i++)
 	{
-		float val = (in[i]+1.0f)*127.5f;
-		if(val<0.0f) val = 0.0f;
-		if(val>255.0f) val=255.0f;
-		out[i]= lookupLinear(val,transferFunctionTable);
+		float xl = inL[i], xr = inR[i];
+		float v3l = xl - s2l;
+		float v3r = xr - s2r;
+		float v1l = a1 * s1l + a2 * v3l;
+		float v1r = a1 * s1r + a2 * v3r;
+		float v2l = s2l + a2 * s1l + a3 * v3l;
+		float v2r = s2r + a2 * s1r + a3 * v3r;
+		s1l = 2.0f * v1l - s1l;
+		s1r = 2.0f * v1r - s1r;
+		s2l = 2.0f * v2l - s2l;
+		s2r = 2.0f * v2r - s2r;
+		outL[i] = m0 * xl + m1 * v1l + m2 * v2l;
+		outR[i] = m0 * xr + m1 * v1r + m2 * v2r;
 	}
+	ic1[0] = s1l; ic2[0] = s2l;
+	ic1[1] = s1r; ic2[1] = s2r;
+}
+
+void stateVariableFilter::process(const float* inL, const float* inR, float* outL, float* outR, const float* cutoffs, int sampleCount)
+{
+	float s1l = ic1[0], s2l = ic2[0], s1r = ic1[1], s2r = ic2[1];
+	float c1, c2, c3;
+	for(int i=0;i<sampleCount;i++)
+	{
+		svfCoef(cutoffs[i], k, c1, c2, c3);
+		float xl = inL[i], xr = inR[i];
+		float v3l = xl - s2l;
+		float v3r = xr - s2r;
+		float v1l = c1 * s1l + c2 * v3l;
+		float v1r = c1 * s1r + c2 * v3r;
+		float v2l = s2l + c2 * s1l + c3 * v3l;
+		float v2r = s2r + c2 * s1r + c3 * v3r;
+		s1l = 2.0f * v1l - s1l;
+		s1r = 2.0f * v1r - s1r;
+		s2l = 2.0f * v2l - s2l;
+		s2r = 2.0f * v2r - s2r;
+		outL[i] = m0 * xl + m1 * v1l + m2 * v2l;
+		outR[i] = m0 * xr + m1 * v1r + m2 * v2r;
+	}
+	ic1[0] = s1l; ic2[0] = s2l;
+	ic1[1] = s1r; ic2[1] = s2r;
 }
 
 //######################################################################
@@ -352,52 +1703,655 @@ void simpleTone::process(float* in, float* out, int sampleCount)
 
 //######################################################################
 // NOISE GATE
+// detector time constants
+#define GATE_PEAK_DECAY_MS	20.0f
+#define GATE_RMS_MS		10.0f
+
+//one-pole coefficient reaching 1-1/e of a step after ms milliseconds, updated every step samples
+static float gateCoef(float ms, int step)
+{
+	if(ms <= 0)
+		return 1.0f;
+	return 1.0f - expf(-(float)step * 1000.0f / (ms * (float)SAMPLE_RATE));
+}
 
 noiseGate::noiseGate()
 {
 	envelope = 0;
+	peakDecay = expf(-1000.0f / (GATE_PEAK_DECAY_MS * (float)SAMPLE_RATE));
+	rmsCoef = gateCoef(GATE_RMS_MS, 1);
+	detector = GD_PEAK;
 	setThreshold(0);
-	
-	//2 stages = 4th order
-	lpf = new biquadFilter(2);
-	
-	//4th order 20Hz lpf (44.1KHz)
-	const float co[] = 
-	{
-		0.000002152381733479521, 0.000004304763466959042, 0.000002152381733479521, 1.9947405124091158, -0.9947486108316238,// b0, b1, b2, a1, a2
-		0.0000019073486328125, 0.000003814697265625, 0.0000019073486328125, 1.997813341671618, -0.9978214525694677// b0, b1, b2, a1, a2
-	};
-	lpf->setCoef(co);
+	setAttack(1);
+	setHold(50);
+	setRelease(100);
+	floorGain = 0;
+	holdCount = 0;
+	open = false;
+	gain = 0;
+	gainStep = 0;
+	subCount = 0;
 }
 
-float noiseGate::process(float in)
+//gate state and gain target at the sub-block boundary, the gain ramps to its next value over the sub-block
+void noiseGate::updateGain()
 {
-	envelope = 1.4142 * lpf->process(fabsf(in));
+	float level = envelope;
+	float openLevel = upperTh;
+	float closeLevel = lowerTh;
+	if(detector == GD_RMS)
+	{
+		//mean square of a sine = peak^2 / 2
+		openLevel = 0.5f * upperTh * upperTh;
+		closeLevel = 0.5f * lowerTh * lowerTh;
+	}
 	
-	//detecting the gate and expansion area
-	if(envelope < lowerTh)
+	if(level > openLevel)
 	{
-		in = 0;
+		open = true;
+		holdCount = holdSamples;
 	}
-	else if(envelope < upperTh)
+	else if(open)
 	{
-		in = in * (envelope - lowerTh)/(upperTh-lowerTh);
+		if(level >= closeLevel)
+			holdCount = holdSamples;
+		else if(holdCount > 0)
+			holdCount -= GATE_SUBBLOCK;
+		else open = false;
 	}
-	return in;
+	
+	float target = open ? 1.0f : floorGain;
+	float coef = (target > gain) ? attackCoef : releaseCoef;
+	float next = gain + (target - gain) * coef;
+	//end the exponential tail at the target (no denormals on the way to a full mute)
+	if(fabsf(next - target) < 1.0e-6f)
+		next = target;
+	gainStep = (next - gain) * (1.0f / (float)GATE_SUBBLOCK);
 }
 
-void noiseGate::process(float* in, float* out, int sampleCount)
+void noiseGate::process(const float* in, float* out, int sampleCount, const float* sidechain)
 {
-	for(int i=0;i<sampleCount;i++)
+	const float* detect = (sidechain != NULL) ? sidechain : in;
+	int i = 0;
+	while(i < sampleCount)
 	{
-		out[i]=process(in[i]);
+		if(subCount == 0)
+		{
+			updateGain();
+			subCount = GATE_SUBBLOCK;
+		}
+		int run = sampleCount - i;
+		if(run > subCount)
+			run = subCount;
+		
+		float env = envelope;
+		float g = gain;
+		if(detector == GD_RMS)
+		{
+			for(int n=i;n<i+run;n++)
+			{
+				float x = detect[n];
+				env += rmsCoef * (x * x - env);
+				out[n] = in[n] * g;
+				g += gainStep;
+			}
+		}
+		else
+		{
+			for(int n=i;n<i+run;n++)
+			{
+				float x = fabsf(detect[n]);
+				env *= peakDecay;
+				if(x > env) env = x;
+				out[n] = in[n] * g;
+				g += gainStep;
+			}
+		}
+		//a decay in silence would end in denormals
+		if(env < 1.0e-15f)
+			env = 0;
+		envelope = env;
+		gain = g;
+		subCount -= run;
+		i += run;
 	}
 }
 
+void noiseGate::process(float* in, float* out, int sampleCount)
+{
+	process(in, out, sampleCount, NULL);
+}
+
+float noiseGate::process(float in)
+{
+	float out;
+	process(&in, &out, 1, NULL);
+	return out;
+}
+
 //0 = -70dB, 1 = -10dB
 void noiseGate::setThreshold(float val)
 {
-	float dB = -70.0f + 60.0f * val;
+	setThresholdDb(-70.0f + 60.0f * val);
+}
+
+void noiseGate::setThresholdDb(float dB)
+{
 	upperTh = powf(10,dB/20.0f);
 	lowerTh = upperTh/2.0f;
 }
+
+void noiseGate::setAttack(float ms)
+{
+	attackCoef = gateCoef(ms, GATE_SUBBLOCK);
+}
+
+void noiseGate::setHold(float ms)
+{
+	holdSamples = (int)(ms * (float)SAMPLE_RATE / 1000.0f);
+}
+
+void noiseGate::setRelease(float ms)
+{
+	releaseCoef = gateCoef(ms, GATE_SUBBLOCK);
+}
+
+void noiseGate::setRange(float dB)
+{
+	floorGain = powf(10, dB/20.0f);
+}
+
+void noiseGate::setDetector(GATE_DETECTOR d)
+{
+	if(d != detector)
+		envelope = 0;
+	detector = d;
+}
+
+bool noiseGate::isOpen()
+{
+	return open;
+}
+
+//######################################################################
+// ENVELOPE FOLLOWER
+// the log mode floor: 1e-6 = -120 dBFS
+#define ENV_LOG_FLOOR		1.0e-6f
+#define ENV_LOG2_TO_DB		6.02059991f
+#define ENV_RMS_MS			10.0f
+
+envelopeFollower::envelopeFollower()
+{
+	mode = EF_PEAK;
+	decimation = 8;
+	attackMs = 2;
+	releaseMs = 100;
+	updateCoef();
+	reset();
+}
+
+void envelopeFollower::updateCoef()
+{
+	attackCoef = gateCoef(attackMs, decimation);
+	releaseCoef = gateCoef(releaseMs, decimation);
+	rmsCoef = gateCoef(ENV_RMS_MS, decimation);
+}
+
+void envelopeFollower::reset()
+{
+	count = 0;
+	accumulator = 0;
+	meanSquare = 0;
+	if(mode == EF_LOG)
+	{
+		envelope = fastLog2(ENV_LOG_FLOOR);
+		value = envelope * ENV_LOG2_TO_DB;
+	}
+	else
+	{
+		envelope = 0;
+		value = 0;
+	}
+}
+
+void envelopeFollower::setMode(ENVELOPE_MODE m)
+{
+	if(m == mode)
+		return;
+	mode = m;
+	reset();
+}
+
+void envelopeFollower::setDecimation(int samples)
+{
+	if(samples < 1) samples = 1;
+	if(samples > MAX_ENVELOPE_DECIMATION) samples = MAX_ENVELOPE_DECIMATION;
+	decimation = samples;
+	count = 0;
+	accumulator = 0;
+	updateCoef();
+}
+
+void envelopeFollower::setAttack(float ms)
+{
+	attackMs = ms;
+	updateCoef();
+}
+
+void envelopeFollower::setRelease(float ms)
+{
+	releaseMs = ms;
+	updateCoef();
+}
+
+//smooth the level of one decimation step
+void envelopeFollower::step(float level)
+{
+	if(mode == EF_RMS)
+	{
+		meanSquare += rmsCoef * (level * (1.0f / (float)decimation) - meanSquare);
+		if(meanSquare < 1.0e-15f) meanSquare = 0;
+		level = meanSquare;
+	}
+	else if(mode == EF_LOG)
+	{
+		if(level < ENV_LOG_FLOOR) level = ENV_LOG_FLOOR;
+		level = fastLog2(level);
+	}
+	
+	float env = envelope;
+	env += ((level > env) ? attackCoef : releaseCoef) * (level - env);
+	
+	if(mode == EF_LOG)
+		value = env * ENV_LOG2_TO_DB;
+	else
+	{
+		//a release in silence would end in denormals
+		if(env < 1.0e-15f) env = 0;
+		value = (mode == EF_RMS) ? sqrtf(env) : env;
+	}
+	envelope = env;
+}
+
+int envelopeFollower::process(const float* in, float* env, int sampleCount)
+{
+	int written = 0;
+	int i = 0;
+	while(i < sampleCount)
+	{
+		int run = sampleCount - i;
+		if(run > decimation - count)
+			run = decimation - count;
+		
+		float acc = accumulator;
+		if(mode == EF_RMS)
+		{
+			for(int n=i;n<i+run;n++)
+				acc += in[n] * in[n];
+		}
+		else
+		{
+			for(int n=i;n<i+run;n++)
+			{
+				float x = fabsf(in[n]);
+				if(x > acc) acc = x;
+			}
+		}
+		count += run;
+		i += run;
+		
+		if(count == decimation)
+		{
+			step(acc);
+			if(env != NULL)
+				env[written] = value;
+			written++;
+			acc = 0;
+			count = 0;
+		}
+		accumulator = acc;
+	}
+	return written;
+}
+
+float envelopeFollower::process(float in)
+{
+	process(&in, NULL, 1);
+	return value;
+}
+
+//######################################################################
+// COMPRESSOR
+// levels and gains are log2 values (1 = 6.02 dB), a step split by the block boundary is smoothed once per part
+
+compressor::compressor()
+{
+	threshold = 0;
+	slope = 0;
+	halfKnee = 0;
+	kneeScale = 0;
+	makeup = 0;
+	lookahead = 0;
+	holdCount = 0;
+	setThreshold(-20);
+	setRatio(4);
+	setKnee(6);
+	setAttack(5);
+	setRelease(100);
+	reset();
+}
+
+void compressor::setThreshold(float dB)
+{
+	threshold = dB * (1.0f / ENV_LOG2_TO_DB);
+}
+
+void compressor::setRatio(float ratio)
+{
+	if(ratio <= 0)
+		slope = -1.0f;
+	else if(ratio < 1.0f)
+		slope = 0;
+	else slope = 1.0f / ratio - 1.0f;
+	kneeScale = (halfKnee > 0) ? slope / (4.0f * halfKnee) : 0;
+}
+
+void compressor::setKnee(float dB)
+{
+	if(dB < 0) dB = 0;
+	halfKnee = 0.5f * dB * (1.0f / ENV_LOG2_TO_DB);
+	kneeScale = (halfKnee > 0) ? slope / (4.0f * halfKnee) : 0;
+}
+
+void compressor::setAttack(float ms)
+{
+	attackCoef = gateCoef(ms, COMP_SUBBLOCK);
+}
+
+void compressor::setRelease(float ms)
+{
+	releaseCoef = gateCoef(ms, COMP_SUBBLOCK);
+}
+
+void compressor::setMakeupGain(float dB)
+{
+	makeup = dB * (1.0f / ENV_LOG2_TO_DB);
+}
+
+void compressor::setLookahead(float ms)
+{
+	int samples = (int)(ms * (float)SAMPLE_RATE / 1000.0f + 0.5f);
+	if(samples < 0) samples = 0;
+	if(samples > COMP_MAX_LOOKAHEAD) samples = COMP_MAX_LOOKAHEAD;
+	lookahead = samples;
+	//a peak leaves the delay up to lookahead samples after its step
+	holdCount = (samples + COMP_SUBBLOCK - 1) / COMP_SUBBLOCK;
+	reset();
+}
+
+void compressor::reset()
+{
+	reduction = 0;
+	gain = fastExp2(makeup);
+	peak = 0;
+	subCount = 0;
+	delayIndex = 0;
+	holdIndex = 0;
+	memset(delayL, 0, sizeof(delayL));
+	memset(delayR, 0, sizeof(delayR));
+	memset(holdPeaks, 0, sizeof(holdPeaks));
+}
+
+float compressor::getGainReduction()
+{
+	return reduction * ENV_LOG2_TO_DB;
+}
+
+//gain computer with soft knee and the attack/release smoothing of the reduction,
+//the coefficients are per step: the smoothed reduction only advances when the step is complete
+float compressor::nextGain(float level, bool endOfStep)
+{
+	float over = fastLog2(level) - threshold;
+	float target;
+	if(over <= -halfKnee)
+		target = 0;
+	else if(over < halfKnee)
+	{
+		float d = over + halfKnee;
+		target = kneeScale * d * d;
+	}
+	else target = slope * over;
+	
+	float r = reduction;
+	r += ((target < r) ? attackCoef : releaseCoef) * (target - r);
+	//end the release tail at 0 dB (no denormals)
+	if(r > -1.0e-7f)
+		r = 0;
+	if(endOfStep)
+		reduction = r;
+	return fastExp2(r + makeup);
+}
+
+//the step is complete, keep its peak for the lookahead
+void compressor::endStep()
+{
+	if(holdCount > 0)
+	{
+		holdPeaks[holdIndex] = peak;
+		holdIndex++;
+		if(holdIndex >= holdCount)
+			holdIndex = 0;
+	}
+	peak = 0;
+}
+
+static void compressorApply(const float* in, float* out, int run, float gain, float step,
+	float* delay, int delayIndex, int lookahead)
+{
+	float g = gain;
+	if(lookahead == 0)
+	{
+		for(int n=0;n<run;n++)
+		{
+			g += step;
+			out[n] = in[n] * g;
+		}
+	}
+	else
+	{
+		int mask = COMP_MAX_LOOKAHEAD - 1;
+		int idx = delayIndex;
+		for(int n=0;n<run;n++)
+		{
+			float x = in[n];
+			g += step;
+			out[n] = delay[(idx - lookahead) & mask] * g;
+			delay[idx] = x;
+			idx = (idx + 1) & mask;
+		}
+	}
+}
+
+void compressor::process(const float* inL, const float* inR, float* outL, float* outR, int sampleCount, const float* sidechain)
+{
+	int i = 0;
+	while(i < sampleCount)
+	{
+		if(subCount == 0)
+			subCount = COMP_SUBBLOCK;
+		int run = sampleCount - i;
+		if(run > subCount)
+			run = subCount;
+		
+		//detector: the peak of the step so far, including the samples of this run
+		float pk = peak;
+		const float* detect = (sidechain != NULL) ? sidechain : inL;
+		for(int n=i;n<i+run;n++)
+		{
+			float x = fabsf(detect[n]);
+			if(x > pk) pk = x;
+		}
+		if((sidechain == NULL) && (inR != NULL))
+		{
+			for(int n=i;n<i+run;n++)
+			{
+				float x = fabsf(inR[n]);
+				if(x > pk) pk = x;
+			}
+		}
+		peak = pk;
+		for(int h=0;h<holdCount;h++)
+		{
+			if(holdPeaks[h] > pk) pk = holdPeaks[h];
+		}
+		
+		//ramp to the gain of the step over the samples left in it, the last sample of the step gets the target
+		bool endOfStep = (run == subCount);
+		float next = nextGain(pk, endOfStep);
+		float step = (next - gain) * (1.0f / (float)subCount);
+		compressorApply(inL + i, outL + i, run, gain, step, delayL, delayIndex, lookahead);
+		if(inR != NULL)
+			compressorApply(inR + i, outR + i, run, gain, step, delayR, delayIndex, lookahead);
+		delayIndex = (delayIndex + run) & (COMP_MAX_LOOKAHEAD - 1);
+		gain = endOfStep ? next : gain + step * (float)run;
+		
+		subCount -= run;
+		i += run;
+		if(subCount == 0)
+			endStep();
+	}
+}
+
+void compressor::process(const float* in, float* out, int sampleCount, const float* sidechain)
+{
+	process(in, NULL, out, NULL, sampleCount, sidechain);
+}
+
+//######################################################################
+// SMOOTHED VALUE
+smoothedValue::smoothedValue()
+{
+	current = 0;
+	target = 0;
+	increment = 0;
+	remaining = 0;
+	setRampTime(20);
+}
+
+void smoothedValue::setRampTime(float ms, bool exponentialRamp)
+{
+	exponential = exponentialRamp;
+	rampLength = (int)(ms * SAMPLE_RATE / 1000.0f);
+	if(rampLength < 1) rampLength = 1;
+	decay = powf(0.001f, 1.0f/(float)rampLength);
+	setValue(target);
+}
+
+void smoothedValue::setTarget(float value)
+{
+	if(value == target)
+		return;
+	target = value;
+	remaining = rampLength;
+	increment = (target - current)/(float)rampLength;
+}
+
+void smoothedValue::setValue(float value)
+{
+	target = value;
+	current = value;
+	remaining = 0;
+}
+
+void smoothedValue::skip(int sampleCount)
+{
+	if(sampleCount >= remaining)
+	{
+		current = target;
+		remaining = 0;
+		return;
+	}
+	remaining -= sampleCount;
+	if(exponential) current = target + powf(decay, (float)sampleCount) * (current - target);
+	else current = current + increment * (float)sampleCount;
+}
+
+void smoothedValue::getValues(float* out, int sampleCount)
+{
+	int i = 0;
+	if(remaining > 0)
+	{
+		//ramp section, the last sample of the ramp lands exactly on the target
+		int n = remaining < sampleCount ? remaining : sampleCount;
+		remaining -= n;
+		int ramped = remaining == 0 ? n-1 : n;
+		float v = current;
+		if(exponential)
+		{
+			for(;i<ramped;i++)
+			{
+				v = target + decay * (v - target);
+				out[i] = v;
+			}
+		}
+		else
+		{
+			for(;i<ramped;i++)
+			{
+				v = v + increment;
+				out[i] = v;
+			}
+		}
+		current = remaining == 0 ? target : v;
+	}
+	//settled section
+	for(;i<sampleCount;i++)
+		out[i] = current;
+}
+
+void smoothedValue::applyGain(const float* in, float* out, int sampleCount)
+{
+	int i = 0;
+	if(remaining > 0)
+	{
+		//ramp section, the last sample of the ramp lands exactly on the target
+		int n = remaining < sampleCount ? remaining : sampleCount;
+		remaining -= n;
+		int ramped = remaining == 0 ? n-1 : n;
+		float v = current;
+		if(exponential)
+		{
+			for(;i<ramped;i++)
+			{
+				v = target + decay * (v - target);
+				out[i] = v * in[i];
+			}
+		}
+		else
+		{
+			for(;i<ramped;i++)
+			{
+				v = v + increment;
+				out[i] = v * in[i];
+			}
+		}
+		current = remaining == 0 ? target : v;
+	}
+	//settled section
+	float g = current;
+	if(g == 1.0f)
+	{
+		if(in != out)
+			for(;i<sampleCount;i++) out[i] = in[i];
+	}
+	else
+	{
+		for(;i<sampleCount;i++)
+			out[i] = g * in[i];
+	}
+}
+
+void smoothedValue::applyGain(float* buffer, int sampleCount)
+{
+	applyGain(buffer, buffer, sampleCount);
+}
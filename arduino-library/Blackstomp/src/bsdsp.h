@@ -28,48 +28,242 @@
 #ifndef BSDSP_H_
 #define BSDSP_H_
 
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
 #include "dsptable.h"
 
 // x = ranges from 0.0 to 255.0; table size is 256 (table[0] to table[255])
 float lookupLinear(float x, const float* table);
 
+//polynomial sine and cosine, any x in radians (max error about 1e-7 after the range reduction)
+float fastSin(float x);
+float fastCos(float x);
+//pade approximation of tan for -pi/2 < x < pi/2 (relative error about 1e-6 up to 0.98 x pi/2)
+float fastTan(float x);
+
+//bit-level log2 and exp2 for gain computers running at the sample rate (a few cpu cycles, no libm call),
+//fastLog2: x > 0, max error 4.5e-4 (0.003 dB), 0 gives -127; fastExp2: max relative error 1.7e-5, x clamped to -126..127
+//both are continuous and monotonic across the octave boundaries
+inline float fastLog2(float x)
+{
+  union {float f; uint32_t i;} u;
+  u.f = x;
+  float e = (float)((int)((u.i >> 23) & 0xff) - 127);
+  u.i = (u.i & 0x007fffff) | 0x3f800000;
+  float t = u.f - 1.0f;
+  return e + t * (1.43995557f + t * (-0.686985469f + t * (0.339990012f + t * -0.0934065559f)));
+}
+
+inline float fastExp2(float x)
+{
+  if(x < -126.0f) x = -126.0f;
+  if(x > 127.0f) x = 127.0f;
+  int xi = (int)x;
+  if(x < (float)xi) xi--;
+  float t = x - (float)xi;
+  union {float f; uint32_t i;} u;
+  u.i = (uint32_t)(xi + 127) << 23;
+  return u.f * (1.0f + t * (0.693061042f + t * (0.241140271f + t * (0.052557228f + t * 0.0132244379f))));
+}
+
+//BIQUAD FILTER DESIGN
+//the designers write the coefficients in the biquadFilter::setCoef() layout (b0,b1,b2,a1,a2 per stage),
+//sampleRate 0 means SAMPLE_RATE, a design takes a few hundred cpu cycles so it can run at every control change
+typedef enum
+{
+  FT_LOWPASS,
+  FT_HIGHPASS,
+  FT_BANDPASS,    //constant 0 dB peak gain
+  FT_NOTCH,
+  FT_PEAKING,     //uses gainDb
+  FT_LOWSHELF,    //uses gainDb, q = 0.7071 for the steepest monotonic shelf
+  FT_HIGHSHELF    //uses gainDb, q = 0.7071 for the steepest monotonic shelf
+}
+FILTER_TYPE;
+
+//one stage from the RBJ audio eq cookbook
+void designBiquad(float* coef, FILTER_TYPE type, float freq, float q, float gainDb=0, float sampleRate=0);
+
+//butterworth low-pass or high-pass of order 2 x stageCount (coef[5 x stageCount])
+void designButterworth(float* coef, int stageCount, bool highPass, float freq, float sampleRate=0);
+
+//linkwitz-riley crossover filter of order 2 x stageCount (coef[5 x stageCount]),
+//the low-pass and high-pass outputs of the same order and frequency sum to a flat magnitude
+//(for an odd stageCount, i.e. LR2 and LR6, the high-pass is designed with inverted polarity for this)
+void designLinkwitzRiley(float* coef, int stageCount, bool highPass, float freq, float sampleRate=0);
+
+//coefficient sets handed from setCoef() (control callbacks, core 0) to the filter's process() (audio task, core 1),
+//the protocol of parameterBlock: three slots, setCoef() fills the writer's slot and publishes it with one atomic swap,
+//process() takes the latest published set at the block boundary (swapping its own slot back),
+//so a set is never read half-written and the last update is never lost
+class biquadCoefExchange
+{
+  private:
+    float* slots[3];              //8 floats per stage each
+    int stages;
+    int front;                    //slot index used by the reader
+    int back;                     //slot index used by the writer
+    bool applied;                 //a set was taken by the reader (the first one is never ramped to)
+    std::atomic<int> published;   //published slot index | FRESH | RAMP
+    std::atomic_flag committing;  //setCoef() may be called from several core-0 tasks
+    enum {FRESH = 4, RAMP = 8};
+  public:
+  biquadCoefExchange();
+  //memory: 3 x 8 x stageCount floats
+  void init(float* memory, int stageCount);
+  //writer side: coef[] in the setCoef() layout, ramp: the reader interpolates to the new set over a block
+  void publish(const float* coef, bool ramp);
+  //reader side: the set published since the last call, NULL if there's none
+  const float* acquire(bool* ramp);
+};
+
 class biquadFilter
 {
   private:
     int stages;
-    void* states;
+    float* coefs;   //8 floats per stage: b0, b1, b2, a1, a2 (16-byte aligned)
+    float* states;  //4 floats per stage: 2 state variables (16-byte aligned)
+    float* memory;  //allocation holding coefs, the exchange slots and states
+    biquadCoefExchange exchange;
   public:
   float process(float in);
   void process(const float* in, float* out, int sampleCount);
-  void setCoef(const float* coef);  //coef[] = {coef stage0, coeff stage1,..} = {b0,b1,b2,a1,a2,b0,b1,b2,a1,a2,..}
+  //coef[] = {coef stage0, coeff stage1,..} = {b0,b1,b2,a1,a2,b0,b1,b2,a1,a2,..},
+  //safe to call from the control callbacks while process() runs, the next process() applies the latest set
+  void setCoef(const float* coef);
+  //set the coefficients gradually: the next block process() moves them sample by sample to the new values,
+  //for filter sweeps without clicks (the sample process() applies them at once)
+  void setCoef(const float* coef, bool interpolate);
   void reset();
+  void reset(float dcInput);  //set the states to the steady state of a constant input (call after setCoef())
 
   biquadFilter(int stageCount);
   ~biquadFilter();
 };
 
+//biquad cascade shared by several channels (lanes): one coefficient set, the states of the lanes side by side,
+//the lanes are filtered in the same inner loop so the coefficients are loaded once per sample for all of them
+class biquadFilterLinked
+{
+  protected:
+    int stages;
+    int lanes;
+    float* coefs;   //8 floats per stage: b0, b1, b2, a1, a2 (16-byte aligned)
+    float* states;  //2 x lanes floats per stage: lane 0 s1, s2, lane 1 s1, s2,..
+    float* memory;  //allocation holding coefs, the exchange slots and states
+    biquadCoefExchange exchange;  //same handoff as biquadFilter
+    void processLanes(const float* const* in, float* const* out, int sampleCount, int stride);
+    biquadFilterLinked(int stageCount, int laneCount);
+  public:
+  void setCoef(const float* coef);  //same layout as biquadFilter::setCoef()
+  void setCoef(const float* coef, bool interpolate); //see biquadFilter::setCoef()
+  void reset();
+  void reset(float dcInput);  //set the states of all lanes to the steady state of a constant input
+  ~biquadFilterLinked();
+};
+
+//stereo-linked biquad cascade, e.g. the same eq on the left and right channels
+class biquadFilterStereo : public biquadFilterLinked
+{
+  public:
+  void process(const float* inL, const float* inR, float* outL, float* outR, int sampleCount);
+  void process(const float* in, float* out, int frameCount); //interleaved L,R frames (PM_INTERLEAVED), in place allowed
+  biquadFilterStereo(int stageCount);
+};
+
+//4-lane biquad cascade, e.g. four voices or a stereo pair of stereo signals
+class biquadFilterQuad : public biquadFilterLinked
+{
+  public:
+  void process(const float* const* in, float* const* out, int sampleCount); //in[4] and out[4] channel buffers
+  biquadFilterQuad(int stageCount);
+};
+
+//fractionalDelay interpolation modes
+typedef enum
+{
+  DI_NONE,      //nearest older sample
+  DI_LINEAR,    //default
+  DI_HERMITE,   //4-point cubic hermite, flatter response for modulated delays, delay >= 1 sample
+  DI_ALLPASS    //first order allpass, flat magnitude, keeps a state: one read stream per delay line,
+                //for fixed or slowly changing delays (e.g. tuning a feedback loop)
+}
+DELAY_INTERPOLATION;
+
+//delay line with a power-of-two ring buffer,
+//the per-sample functions write one sample then read it back with a delay of 0 or more,
+//the block functions write a block then read it back with each sample's own write position as the reference
 class fractionalDelay
 {
 	private:
-	int bufflength;
+	int bufflength; //power of two
+	int mask;
 	int writeIndex;
 	float* buffer;
 	float sampleCountPerMs;
 	float maxdelay;
+	float maxDelaySamples;
+	DELAY_INTERPOLATION interpolation;
+	float allpassState;
+	friend class multiTapDelay;
 	
 	public:
 	fractionalDelay(); 
 	~fractionalDelay();
 	bool init(float maxDelayInMs);//max delay in milliseconds
+	bool initSamples(int maxDelayInSamples);
+	void setInterpolation(DELAY_INTERPOLATION mode);
+	float getSampleCountPerMs(); //delay in samples = delay in ms x getSampleCountPerMs(), convert once, not per sample
+	void clear();
 	void write(float sample);
 	float read(float delayInMs);
+	float readSamples(float delayInSamples);
+	
+	//block write and read: write() the block first, then read() it back any number of times,
+	//the delay of out[i] is delayInSamples + modulation[i] (modulation may be NULL),
+	//clamped to 0 (1 for DI_HERMITE) .. max delay, blocks of up to MAX_AUDIO_BLOCK samples,
+	//with feedback the delay must be at least one block, out may be the modulation buffer
+	void write(const float* in, int sampleCount);
+	void read(float* out, int sampleCount, float delayInSamples, const float* modulation=NULL);
+};
+
+//one tap of multiTapDelay: delay = delayInSamples + depth x modulation[i]
+struct DELAYTAP
+{
+  float delayInSamples;
+  float gain;
+  const float* modulation;  //per-sample modulation buffer (may be shared by several taps), NULL: fixed delay
+  float depth;
+};
+
+//several taps read from one fractionalDelay in a single block pass, e.g. chorus voices or rhythmic delay taps,
+//the taps are read after fractionalDelay::write() of the block, with DI_HERMITE the taps use the hermite
+//interpolation, otherwise linear (DI_ALLPASS is read as linear)
+class multiTapDelay
+{
+  private:
+  int maxTaps;
+  int tapCount;
+  DELAYTAP* taps;
+  
+  public:
+  multiTapDelay(int maxTapCount);
+  ~multiTapDelay();
+  void setTapCount(int count); //active taps, 0 .. maxTapCount
+  int getTapCount();
+  void setTap(int index, float delayInSamples, float gain, const float* modulation=NULL, float depth=1.0f);
+  void setTapDelay(int index, float delayInSamples);
+  void setTapGain(int index, float gain);
+  void read(fractionalDelay& line, float* out, int sampleCount);  //sum of the taps x gains
+  void readTaps(fractionalDelay& line, float* const* tapOut, int sampleCount);  //tapOut[n] = tap n x gain
 };
 
 class oscillator
 {
 	private:
-	float phaseincrement;
-	float phase;
+	uint32_t phaseincrement; //32-bit phase, one cycle = 2^32
+	uint32_t phase;
 	const float* waveTable;
 	
 	public:
@@ -86,6 +280,49 @@ class oscillator
 	float getOutput();
 };
 
+//oscillatorBank waveforms
+typedef enum
+{
+  OS_SINE,
+  OS_TRIANGLE,
+  OS_SAW,       //polyBLEP band-limited, rising
+  OS_SQUARE,    //polyBLEP band-limited
+  OS_TABLE      //setWaveTable() (256 entries, one cycle over 0..255 like sin_table)
+}
+OSC_SHAPE;
+
+//bank of oscillators with exact 32-bit integer phase accumulators,
+//audio rate: generate() writes a block of one oscillator (multi-phase outputs share its phase),
+//lfo mode: update() advances the whole bank by a block and getValue() returns each one's value at the block start
+class oscillatorBank
+{
+	private:
+	int count;
+	uint32_t* phases;
+	uint32_t* increments;
+	OSC_SHAPE* shapes;
+	const float** tables;
+	float* values;
+	float shapeValue(int index, uint32_t p);
+	
+	public:
+	oscillatorBank(int oscillatorCount);
+	~oscillatorBank();
+	int getCount();
+	void setFrequency(int index, float freq);
+	void setPhase(int index, float p); //0 .. 1.0 (one cycle)
+	void setShape(int index, OSC_SHAPE shape);
+	void setWaveTable(int index, const float* wtable); //also selects OS_TABLE
+	
+	void generate(int index, float* out, int sampleCount);
+	//outs[k] = the same oscillator shifted by phaseOffsets[k] (0 .. 1.0)
+	void generate(int index, float* const* outs, const float* phaseOffsets, int outputCount, int sampleCount);
+	void generateQuadrature(int index, float* out0, float* out90, int sampleCount);
+	
+	void update(int sampleCount);  //lfo mode: values at the current phase, then advance all phases
+	float getValue(int index);
+};
+
 class waveShaper
 {
 	public:
@@ -98,6 +335,39 @@ class waveShaper
 		float process(float in);
 };
 
+//waveshaper with a high resolution table (1024 .. 4096 points) and first order antiderivative anti-aliasing (ADAA):
+//y = (F(x) - F(x1)) / (x - x1), F = integral of the transfer function (tabulated with it), which
+//suppresses much of the aliasing of high gains at a fraction of the cost of oversampling,
+//the output is delayed by half a sample, inputs beyond -1 .. 1 hold the end values of the transfer function
+class waveShaperADAA
+{
+	private:
+	int size;       //table intervals over x = -1 .. 1
+	float scale;    //size / 2
+	float step;     //2 / size
+	float* table;   //transfer function, size + 2 points (with a guard point)
+	float* integral;  //its integral from x = -1, size + 2 points
+	float* memory;
+	bool antialiasing;
+	float x1;       //previous input
+	float F1;       //integral at the previous input
+	void buildIntegral();
+	float transfer(float x);
+	float antiderivative(float x);
+	
+	public:
+	waveShaperADAA(int tableSize=2048);
+	~waveShaperADAA();
+	//resample a transfer function table of length points over x = -1 .. 1 (e.g. waveShaper::transferFunctionTable, 256)
+	void setTransferFunction(const float* transferTable, int length);
+	//evaluate a transfer function at each table point (not in the audio path)
+	void setTransferFunction(float (*transferFunction)(float x));
+	void setAntialiasing(bool enable); //false: plain interpolated lookup, default: true
+	void reset();
+	float process(float in);
+	void process(const float* in, float* out, int sampleCount);
+};
+
 class rcHiPass
 {
 	private:
@@ -124,6 +394,37 @@ class rcLoPass
 	void process(float* in, float* out, int sampleCount);
 };
 
+//topology-preserving (zero-delay feedback) state variable filter, trapezoidal integrators,
+//stays stable when the cutoff changes every sample (envelope wah, auto-filter, synth filter sweeps),
+//the single-output process() uses the setMode() response: FT_LOWPASS, FT_HIGHPASS, FT_BANDPASS (0 dB peak) or FT_NOTCH,
+//the cutoff buffers hold one cutoff frequency (Hz) per sample, with one division per sample for the coefficients,
+//channel 0 is the mono channel, the stereo functions use channels 0 and 1 with the same coefficients
+class stateVariableFilter
+{
+	private:
+	float k;              //1/q
+	float a1, a2, a3;     //coefficients at the fixed cutoff
+	FILTER_TYPE mode;
+	float m0, m1, m2;     //output mix of input, band-pass and low-pass
+	float ic1[2], ic2[2]; //integrator states per channel
+	float cutoff;
+	void updateCoef();
+	
+	public:
+	stateVariableFilter();
+	void setCutOff(float freq);
+	void setQ(float q);     //0.5 .. 20, 0.7071 for the butterworth response
+	void setMode(FILTER_TYPE mode);
+	void reset();
+	float process(float in);
+	void process(const float* in, float* out, int sampleCount);
+	void process(const float* in, float* out, const float* cutoffs, int sampleCount);
+	//all the responses at once (mono)
+	void processAll(const float* in, float* lowOut, float* bandOut, float* highOut, float* notchOut, int sampleCount);
+	void process(const float* inL, const float* inR, float* outL, float* outR, int sampleCount);
+	void process(const float* inL, const float* inR, float* outL, float* outR, const float* cutoffs, int sampleCount);
+};
+
 class simpleTone
 {
 	private:
@@ -138,19 +439,204 @@ class simpleTone
 	void setTone(float val);	//0.0-1.0
 };
 
+//noiseGate level detectors
+typedef enum
+{
+  GD_PEAK,  //peak follower (default)
+  GD_RMS    //rms follower, calibrated so that a sine opens at the same threshold as with GD_PEAK
+}
+GATE_DETECTOR;
+
+//gate with hysteresis (opens at the threshold, closes 6 dB below it), attack, hold and release,
+//the level detector runs every sample, the gain is computed every GATE_SUBBLOCK samples and ramped linearly in between,
+//the optional sidechain feeds the detector instead of the input (e.g. the clean input while gating a processed signal)
+#define GATE_SUBBLOCK 8
 class noiseGate
 {
 	private:
-	biquadFilter* lpf;
-	float upperTh;
-	float lowerTh;
-	float envelope;
+	float upperTh;    //open threshold (peak level)
+	float lowerTh;    //close threshold
+	float envelope;   //peak or mean square level
+	float peakDecay;  //per sample decay of the peak follower
+	float rmsCoef;    //mean square follower coefficient
+	GATE_DETECTOR detector;
+	float attackCoef; //per sub-block smoothing towards the open gain
+	float releaseCoef;
+	int holdSamples;
+	int holdCount;
+	bool open;
+	float floorGain;  //gain when closed
+	float gain;       //current gain
+	float gainStep;   //per sample gain increment within the sub-block
+	int subCount;     //samples left in the current sub-block
+	void updateGain();
 	
 	public:
 	noiseGate();
 	float process(float in);
 	void process(float* in, float* out, int sampleCount);
+	void process(const float* in, float* out, int sampleCount, const float* sidechain);
 	void setThreshold(float val); //0 = -70dB, 1 = -10dB
+	void setThresholdDb(float dB);
+	void setAttack(float ms);     //default 1 ms
+	void setHold(float ms);       //default 50 ms
+	void setRelease(float ms);    //default 100 ms
+	void setRange(float dB);      //attenuation when closed, e.g. -40, default: full mute
+	void setDetector(GATE_DETECTOR d);
+	bool isOpen();
+};
+
+typedef enum
+{
+  EF_PEAK,  //peak amplitude
+  EF_RMS,   //rms amplitude (10 ms mean square average before the attack and release smoothing)
+  EF_LOG    //peak level in dB, smoothed in the log domain (constant dB per second release)
+}
+ENVELOPE_MODE;
+
+//level detector for modulation sources and dynamics (auto-wah, envelope tremolo, ducking),
+//the input is reduced to one value per decimation step (peak: maximum, rms: mean square) 
+//and then smoothed with separate attack and release times, so the per-sample cost is one compare or multiply-add,
+//the block process writes the control-rate envelope, one value per decimation step
+#define MAX_ENVELOPE_DECIMATION 64
+class envelopeFollower
+{
+	private:
+	ENVELOPE_MODE mode;
+	int decimation;
+	int count;          //samples accumulated in the current step
+	float accumulator;  //running peak or sum of squares of the current step
+	float meanSquare;   //rms mode average
+	float rmsCoef;
+	float envelope;     //smoothed level: amplitude, mean square or log2
+	float value;        //output in the mode's unit
+	float attackMs;
+	float releaseMs;
+	float attackCoef;   //per step smoothing when the level rises
+	float releaseCoef;  //per step smoothing when the level falls
+	void updateCoef();
+	void step(float level);
+	
+	public:
+	envelopeFollower();
+	void setMode(ENVELOPE_MODE m);
+	//samples per envelope value, 1..MAX_ENVELOPE_DECIMATION (default: 8)
+	void setDecimation(int samples);
+	int getDecimation(){return decimation;}
+	void setAttack(float ms);   //default 2 ms, 0 = instant
+	void setRelease(float ms);  //default 100 ms
+	void reset();
+	//sample processing mode: returns the latest envelope value
+	float process(float in);
+	//block processing mode: writes one envelope value per completed decimation step to env (may be NULL),
+	//a partial step is carried to the next call, returns the number of values written
+	//(sampleCount/decimation when the block size is a multiple of the decimation)
+	int process(const float* in, float* env, int sampleCount);
+	//latest envelope value: amplitude (EF_PEAK, EF_RMS) or dBFS (EF_LOG, floor at -120 dB)
+	float getValue(){return value;}
+};
+
+//feed-forward compressor and limiter with soft knee, the gain computer works on log2 levels (fastLog2/fastExp2),
+//the input is split into COMP_SUBBLOCK-sample steps: the peak of the step sets the gain target,
+//the smoothed gain reduction is computed once per step and ramped linearly over it (a compare and a multiply per sample),
+//the lookahead delays the audio (not the detector) so the gain is already down when a peak comes out,
+//with attack 0 and at least COMP_SUBBLOCK samples of lookahead it is a brickwall limiter,
+//the sidechain (e.g. the mic channel in IM_LMIC mode ducking the line input) feeds the detector instead of the input
+#define COMP_SUBBLOCK       8
+#define COMP_MAX_LOOKAHEAD  256
+class compressor
+{
+	private:
+	float threshold;    //log2 level
+	float slope;        //1/ratio - 1
+	float halfKnee;     //log2 level
+	float kneeScale;    //slope / (2 x knee width)
+	float makeup;       //log2 gain
+	float attackCoef;   //per step smoothing when the reduction increases
+	float releaseCoef;
+	float reduction;    //smoothed gain reduction, log2 gain <= 0
+	float gain;         //current linear gain
+	float peak;         //peak of the current step so far
+	int subCount;       //samples left in the current step
+	int lookahead;      //samples
+	int delayIndex;
+	float delayL[COMP_MAX_LOOKAHEAD];
+	float delayR[COMP_MAX_LOOKAHEAD];
+	int holdCount;      //step peaks kept for the lookahead
+	int holdIndex;
+	float holdPeaks[COMP_MAX_LOOKAHEAD/COMP_SUBBLOCK];
+	float nextGain(float level, bool endOfStep);
+	void endStep();
+	
+	public:
+	compressor();
+	void setThreshold(float dB);  //default -20 dB
+	void setRatio(float ratio);   //1..; 0 = infinite (limiter), default 4
+	void setKnee(float dB);       //knee width, default 6 dB, 0 = hard knee
+	void setAttack(float ms);     //default 5 ms, 0 = instant
+	void setRelease(float ms);    //default 100 ms
+	void setMakeupGain(float dB); //default 0 dB
+	//the output is delayed by the lookahead, 0 .. COMP_MAX_LOOKAHEAD samples (5.8 ms), default 0
+	void setLookahead(float ms);
+	void reset();
+	//current gain reduction in dB (<= 0), for metering
+	float getGainReduction();
+	//block processing mode, in place allowed, sidechain may be NULL
+	void process(const float* in, float* out, int sampleCount, const float* sidechain=NULL);
+	//stereo linked: one gain from the louder channel (or the sidechain) for both
+	void process(const float* inL, const float* inR, float* outL, float* outR, int sampleCount, const float* sidechain=NULL);
+};
+
+//parameter smoother against zipper noise, e.g. gains and modulation depths
+//set the new target once per block with setTarget(), then read it per sample with next(),
+//or apply it to a whole block with getValues() or applyGain()
+//once the ramp is finished the value stays constant and the block functions take the cheap path
+class smoothedValue
+{
+	private:
+	float current;
+	float target;
+	float increment;	//linear ramp: step per sample
+	float decay;		//exponential ramp: error factor per sample
+	int rampLength;		//ramp duration in samples
+	int remaining;		//samples left in the current ramp
+	bool exponential;
+	
+	public:
+	smoothedValue();
+	//ramp duration, linear or exponential (one-pole approach reaching -60dB of the distance at the end of the ramp)
+	//default: 20ms linear, a ramp in progress jumps to its target
+	void setRampTime(float ms, bool exponentialRamp=false);
+	//start a ramp to a new value (ignored if the target doesn't change)
+	void setTarget(float value);
+	//jump to a value without ramp
+	void setValue(float value);
+	float getTarget(){return target;}
+	float getValue(){return current;}
+	bool isRamping(){return remaining > 0;}
+	
+	//sample processing mode: advance one sample and return the value
+	inline float next()
+	{
+		if(remaining > 0)
+		{
+			remaining--;
+			if(remaining == 0) current = target;
+			else if(exponential) current = target + decay * (current - target);
+			else current = current + increment;
+		}
+		return current;
+	}
+	
+	//advance the ramp by sampleCount samples without reading it
+	void skip(int sampleCount);
+	
+	//block processing mode: write the next sampleCount values to out (e.g. for coefficient ramps)
+	void getValues(float* out, int sampleCount);
+	
+	//block processing mode: multiply the signal by the next sampleCount values
+	void applyGain(const float* in, float* out, int sampleCount);
+	void applyGain(float* buffer, int sampleCount);
 };
 
 #endif
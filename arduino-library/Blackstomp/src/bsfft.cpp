@@ -0,0 +1,1110 @@
+/*!
+ *  @file       bsfft.cpp
+ *  Project     Blackstomp Arduino Library
+ *  @brief      Blackstomp Library for the Arduino
+ *  @author     Hasan Murod
+ *  @date       17/10/2026
+ *  @license    MIT - Copyright (c) 2020 Hasan Murod
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#include "bsfft.h"
+#include "blackstomp.h"
+#include <math.h>
+#include <string.h>
+
+//ESP-DSP's Xtensa kernels when they are available, portable C otherwise (and on the host)
+#if defined(ARDUINO_ARCH_ESP32) && defined(__has_include)
+#if __has_include(<dsps_fft2r.h>)
+#include <dsps_fft2r.h>
+#define FFT_USE_DSPS
+#ifndef CONFIG_DSP_MAX_FFT_SIZE
+#define CONFIG_DSP_MAX_FFT_SIZE 4096
+#endif
+#endif
+#if __has_include(<dsps_dotprod.h>)
+#include <dsps_dotprod.h>
+#define CONV_USE_DSPS
+#endif
+#endif
+
+#define FFT_MIN_SIZE	16
+#define FFT_MAX_SIZE	4096
+
+//######################################################################
+// REAL FFT
+// the size real samples are taken as size/2 complex samples (even: real part, odd: imaginary part),
+// transformed by a complex FFT, then split into the spectrum of the real signal:
+// X[k] = Xe[k] + W^k.Xo[k], Xe[k] = (Z[k] + Z*[N/2-k])/2, Xo[k] = -i(Z[k] - Z*[N/2-k])/2, W = exp(-2.pi.i/N)
+
+#ifdef FFT_USE_DSPS
+//ESP-DSP keeps one global twiddle table for all the sizes up to CONFIG_DSP_MAX_FFT_SIZE
+static bool dspsFftReady = false;
+#endif
+
+realFFT::realFFT(int fftSize)
+{
+  size = FFT_MIN_SIZE;
+  while((size < fftSize) && (size < FFT_MAX_SIZE))
+    size <<= 1;
+  half = size/2;
+
+  twiddles = new float[half];
+  for(int k=0;k<half/2;k++)
+  {
+    double a = 2.0 * M_PI * k / half;
+    twiddles[2*k] = (float)cos(a);
+    twiddles[2*k+1] = (float)-sin(a);
+  }
+
+  split = new float[half+2];
+  for(int k=0;k<=half/2;k++)
+  {
+    double a = 2.0 * M_PI * k / size;
+    split[2*k] = (float)cos(a);
+    split[2*k+1] = (float)-sin(a);
+  }
+
+  //bit reversal as a list of index pairs to swap
+  swaps = new uint16_t[half];
+  swapCount = 0;
+  int bits = 0;
+  while((1 << bits) < half)
+    bits++;
+  for(int i=0;i<half;i++)
+  {
+    int r = 0;
+    for(int b=0;b<bits;b++)
+      if(i & (1 << b)) r |= 1 << (bits-1-b);
+    if(i < r)
+    {
+      swaps[swapCount++] = i;
+      swaps[swapCount++] = r;
+    }
+  }
+
+#ifdef FFT_USE_DSPS
+  if(!dspsFftReady)
+    dspsFftReady = (dsps_fft2r_init_fc32(NULL, CONFIG_DSP_MAX_FFT_SIZE) == ESP_OK);
+#endif
+}
+
+realFFT::~realFFT()
+{
+  delete[] twiddles;
+  delete[] split;
+  delete[] swaps;
+}
+
+//in-place complex FFT of half points, interleaved real and imaginary parts
+void realFFT::complexFFT(float* data)
+{
+#ifdef FFT_USE_DSPS
+  if(dspsFftReady && (half <= CONFIG_DSP_MAX_FFT_SIZE))
+  {
+    dsps_fft2r_fc32(data, half);
+    dsps_bit_rev_fc32(data, half);
+    return;
+  }
+#endif
+
+  for(int i=0;i<swapCount;i+=2)
+  {
+    int a = 2*swaps[i];
+    int b = 2*swaps[i+1];
+    float re = data[a];
+    float im = data[a+1];
+    data[a] = data[b];
+    data[a+1] = data[b+1];
+    data[b] = re;
+    data[b+1] = im;
+  }
+
+  //first stage, the twiddle is 1
+  for(int i=0;i<2*half;i+=4)
+  {
+    float re = data[i+2];
+    float im = data[i+3];
+    data[i+2] = data[i] - re;
+    data[i+3] = data[i+1] - im;
+    data[i] += re;
+    data[i+1] += im;
+  }
+
+  //radix-2 decimation in time, one twiddle per inner loop
+  for(int len=4;len<=half;len<<=1)
+  {
+    int span = len/2;
+    int step = half/len;
+    for(int j=0;j<span;j++)
+    {
+      float wr = twiddles[2*j*step];
+      float wi = twiddles[2*j*step+1];
+      for(int i=j;i<half;i+=len)
+      {
+        float* a = data + 2*i;
+        float* b = data + 2*(i+span);
+        float tr = b[0] * wr - b[1] * wi;
+        float ti = b[0] * wi + b[1] * wr;
+        b[0] = a[0] - tr;
+        b[1] = a[1] - ti;
+        a[0] += tr;
+        a[1] += ti;
+      }
+    }
+  }
+}
+
+void realFFT::forward(const float* in, float* out)
+{
+  if(out != in)
+    memcpy(out, in, size * sizeof(float));
+  complexFFT(out);
+
+  float zr = out[0];
+  float zi = out[1];
+  out[0] = zr + zi;
+  out[1] = zr - zi;
+
+  //bins k and half-k together, in place
+  for(int k=1;k<=half/2;k++)
+  {
+    float* a = out + 2*k;
+    float* b = out + 2*(half-k);
+    float ar = a[0], ai = a[1];
+    float br = b[0], bi = -b[1];
+    float er = 0.5f * (ar + br);
+    float ei = 0.5f * (ai + bi);
+    float or_ = 0.5f * (ai - bi);
+    float oi = -0.5f * (ar - br);
+    float wr = split[2*k];
+    float wi = split[2*k+1];
+    float tr = wr * or_ - wi * oi;
+    float ti = wr * oi + wi * or_;
+    a[0] = er + tr;
+    a[1] = ei + ti;
+    b[0] = er - tr;
+    b[1] = ti - ei;
+  }
+}
+
+void realFFT::inverse(const float* in, float* out)
+{
+  //Z = Xe + i.Xo, the inverse complex FFT is conj(FFT(conj(Z)))/half
+  float scale = 1.0f / (float)half;
+  float x0 = in[0];
+  float xn = in[1];
+  out[0] = 0.5f * (x0 + xn) * scale;
+  out[1] = -0.5f * (x0 - xn) * scale;
+
+  for(int k=1;k<=half/2;k++)
+  {
+    const float* a = in + 2*k;
+    const float* b = in + 2*(half-k);
+    float ar = a[0], ai = a[1];
+    float br = b[0], bi = -b[1];
+    float er = 0.5f * (ar + br);
+    float ei = 0.5f * (ai + bi);
+    float dr = 0.5f * (ar - br);
+    float di = 0.5f * (ai - bi);
+    //Xo = d.conj(W^k)
+    float wr = split[2*k];
+    float wi = -split[2*k+1];
+    float or_ = dr * wr - di * wi;
+    float oi = dr * wi + di * wr;
+    //Z[k] = Xe + i.Xo, Z[half-k] = conj(Xe) + i.conj(Xo), stored conjugated and scaled
+    float zkr = er - oi;
+    float zki = ei + or_;
+    float zjr = er + oi;
+    float zji = or_ - ei;
+    out[2*k] = zkr * scale;
+    out[2*k+1] = -zki * scale;
+    out[2*(half-k)] = zjr * scale;
+    out[2*(half-k)+1] = -zji * scale;
+  }
+
+  complexFFT(out);
+  for(int i=1;i<size;i+=2)
+    out[i] = -out[i];
+}
+
+//######################################################################
+// PARTITIONED CONVOLVER
+// overlap-save: the FFT of the last 2 partitions of input times the spectrum of a zero-padded IR partition
+// gives the partition's contribution to the next P output samples in the second half of the inverse FFT,
+// the spectra of the past inputs are kept (frequency-domain delay line), so one forward and one inverse FFT
+// per partition serve all the IR partitions,
+// a job started at the end of partition m delivers the tail for partition m+1 (inline) or m+2 (core 0),
+// so the time-domain head covers the first P or 2P taps
+
+//the job numbers wrap at a multiple of the 3 output slots
+#define CONV_JOB_WRAP		(3 << 28)
+//above the control tasks, same as the core-0 stage of the pipelined mode
+#define CONV_TASK_PRIORITY	11
+
+partitionedConvolver::partitionedConvolver()
+{
+	partition = 0;
+	headLength = 0;
+	tailLag = 1;
+	tailCount = 0;
+	headTaps = NULL;
+	headHistory = NULL;
+	headIndex = 0;
+	fft = NULL;
+	irSpectra = NULL;
+	inputSpectra = NULL;
+	accumulator = NULL;
+	inputBuffer = NULL;
+	jobInput = NULL;
+	tailOutput = NULL;
+	task = NULL;
+	stopTask = false;
+	fdlIndex = 0;
+	reset();
+}
+
+partitionedConvolver::~partitionedConvolver()
+{
+	release();
+}
+
+void partitionedConvolver::release()
+{
+#ifdef ARDUINO_ARCH_ESP32
+	if(task != NULL)
+	{
+		//the task clears the flag on its way out
+		stopTask = true;
+		xTaskNotifyGive((TaskHandle_t)task);
+		while(stopTask)
+			vTaskDelay(1);
+		task = NULL;
+	}
+#endif
+	delete[] headTaps;
+	delete[] headHistory;
+	delete fft;
+	free(irSpectra);
+	delete[] inputSpectra;
+	delete[] accumulator;
+	delete[] inputBuffer;
+	delete[] jobInput;
+	delete[] tailOutput;
+	headTaps = NULL;
+	headHistory = NULL;
+	fft = NULL;
+	irSpectra = NULL;
+	inputSpectra = NULL;
+	accumulator = NULL;
+	inputBuffer = NULL;
+	jobInput = NULL;
+	tailOutput = NULL;
+	headLength = 0;
+	tailCount = 0;
+}
+
+bool partitionedConvolver::init(const float* ir, int irLength, int partitionSize, bool tailOnCore0)
+{
+	release();
+	if((ir == NULL) || (irLength < 1))
+		return false;
+	if((partitionSize < CONV_MIN_PARTITION) || (partitionSize > CONV_MAX_PARTITION) || (partitionSize & (partitionSize-1)))
+		return false;
+
+	partition = partitionSize;
+	tailLag = tailOnCore0 ? 2 : 1;
+	headLength = tailLag * partition;
+	if(headLength > irLength)
+		headLength = irLength;
+	tailCount = (irLength - headLength + partition - 1) / partition;
+	int fftSize = 2 * partition;
+
+	headTaps = new float[headLength];
+	headHistory = new float[2 * headLength];
+	if((headTaps == NULL) || (headHistory == NULL))
+	{
+		release();
+		return false;
+	}
+	for(int i=0;i<headLength;i++)
+		headTaps[i] = ir[headLength-1-i];
+
+	if(tailCount > 0)
+	{
+		fft = new realFFT(fftSize);
+		size_t spectraBytes = (size_t)tailCount * fftSize * sizeof(float);
+		irSpectra = (float*)ps_malloc(spectraBytes);
+		if(irSpectra == NULL)
+			irSpectra = (float*)malloc(spectraBytes);
+		inputSpectra = new float[tailCount * fftSize];
+		accumulator = new float[fftSize];
+		inputBuffer = new float[fftSize];
+		tailOutput = new float[3 * partition];
+		if(tailOnCore0)
+			jobInput = new float[fftSize];
+		if((fft == NULL) || (irSpectra == NULL) || (inputSpectra == NULL) || (accumulator == NULL)
+			|| (inputBuffer == NULL) || (tailOutput == NULL) || (tailOnCore0 && (jobInput == NULL)))
+		{
+			release();
+			return false;
+		}
+
+		//IR partitions zero-padded to the FFT size
+		for(int j=0;j<tailCount;j++)
+		{
+			float* spectrum = irSpectra + j * fftSize;
+			int offset = headLength + j * partition;
+			int count = irLength - offset;
+			if(count > partition)
+				count = partition;
+			for(int i=0;i<fftSize;i++)
+				accumulator[i] = (i < count) ? ir[offset + i] : 0;
+			fft->forward(accumulator, spectrum);
+		}
+	}
+	reset();
+
+#ifdef ARDUINO_ARCH_ESP32
+	//on the host the core-0 job runs inline, with the same 2-partition lag
+	if(tailOnCore0 && (tailCount > 0))
+	{
+		TaskHandle_t handle = NULL;
+		stopTask = false;
+		xTaskCreatePinnedToCore(taskLoop, "conv_task", 4096, this, CONV_TASK_PRIORITY, &handle, 0);
+		task = handle;
+	}
+#endif
+	return true;
+}
+
+void partitionedConvolver::reset()
+{
+	if(headHistory != NULL)
+		memset(headHistory, 0, 2 * headLength * sizeof(float));
+	if(tailCount > 0)
+	{
+		memset(inputSpectra, 0, tailCount * 2 * partition * sizeof(float));
+		memset(inputBuffer, 0, 2 * partition * sizeof(float));
+		memset(tailOutput, 0, 3 * partition * sizeof(float));
+	}
+	for(int i=0;i<3;i++)
+		slotJob[i] = -1;
+	headIndex = 0;
+	position = 0;
+	period = 0;
+	warmup = tailLag;
+	tailReady = false;
+	misses = 0;
+	posted = -1;
+	finished = -1;
+	lastJob = -1;
+	fdlIndex = 0;
+}
+
+#ifdef ARDUINO_ARCH_ESP32
+void partitionedConvolver::taskLoop(void* arg)
+{
+	partitionedConvolver* conv = (partitionedConvolver*)arg;
+	while(!conv->stopTask)
+	{
+		ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+		int job = conv->posted.load(std::memory_order_acquire);
+		if(job != conv->finished.load(std::memory_order_relaxed))
+		{
+			conv->runTail(conv->jobInput, job);
+			conv->finished.store(job, std::memory_order_release);
+		}
+	}
+	conv->stopTask = false;
+	vTaskDelete(NULL);
+}
+#else
+void partitionedConvolver::taskLoop(void* arg)
+{
+}
+#endif
+
+//spectrum of the input partition into the delay line, multiply-accumulate with the IR partitions,
+//inverse FFT, the valid half goes to the output slot of the job
+void partitionedConvolver::runTail(const float* in, int job)
+{
+	int fftSize = 2 * partition;
+
+	//the partitions of skipped jobs (core 0 was late) are silent
+	int skipped = 0;
+	if(lastJob >= 0)
+	{
+		skipped = (job - lastJob + CONV_JOB_WRAP) % CONV_JOB_WRAP - 1;
+		if(skipped > tailCount)
+			skipped = tailCount;
+	}
+	for(int s=0;s<skipped;s++)
+	{
+		fdlIndex = (fdlIndex + 1 == tailCount) ? 0 : fdlIndex + 1;
+		memset(inputSpectra + fdlIndex * fftSize, 0, fftSize * sizeof(float));
+	}
+	fdlIndex = (fdlIndex + 1 == tailCount) ? 0 : fdlIndex + 1;
+	fft->forward(in, inputSpectra + fdlIndex * fftSize);
+	lastJob = job;
+
+	//IR partition j meets the input spectrum of j partitions ago
+	float* acc = accumulator;
+	int slot = fdlIndex;
+	for(int j=0;j<tailCount;j++)
+	{
+		const float* x = inputSpectra + slot * fftSize;
+		const float* h = irSpectra + j * fftSize;
+		if(j == 0)
+		{
+			acc[0] = x[0] * h[0];
+			acc[1] = x[1] * h[1];
+			for(int b=2;b<fftSize;b+=2)
+			{
+				acc[b] = x[b] * h[b] - x[b+1] * h[b+1];
+				acc[b+1] = x[b] * h[b+1] + x[b+1] * h[b];
+			}
+		}
+		else
+		{
+			acc[0] += x[0] * h[0];
+			acc[1] += x[1] * h[1];
+			for(int b=2;b<fftSize;b+=2)
+			{
+				acc[b] += x[b] * h[b] - x[b+1] * h[b+1];
+				acc[b+1] += x[b] * h[b+1] + x[b+1] * h[b];
+			}
+		}
+		slot = (slot == 0) ? tailCount - 1 : slot - 1;
+	}
+	fft->inverse(acc, acc);
+
+	int out = job % 3;
+	memcpy(tailOutput + out * partition, acc + partition, partition * sizeof(float));
+	slotJob[out].store(job, std::memory_order_release);
+}
+
+//partition boundary: start the tail job of the finished partition, select the tail output of the next one
+void partitionedConvolver::endPartition()
+{
+	position = 0;
+	if(tailCount > 0)
+	{
+		if(task == NULL)
+			runTail(inputBuffer, period);
+		else if(finished.load(std::memory_order_acquire) == posted.load(std::memory_order_relaxed))
+		{
+			memcpy(jobInput, inputBuffer, 2 * partition * sizeof(float));
+			posted.store(period, std::memory_order_release);
+#ifdef ARDUINO_ARCH_ESP32
+			xTaskNotifyGive((TaskHandle_t)task);
+#endif
+		}
+		//else core 0 is still busy with the previous job, this partition is skipped
+		memcpy(inputBuffer, inputBuffer + partition, partition * sizeof(float));
+	}
+
+	period = (period + 1 == CONV_JOB_WRAP) ? 0 : period + 1;
+	int want = period - tailLag;
+	if(want < 0)
+		want += CONV_JOB_WRAP;
+	tailReady = (tailCount > 0) && (slotJob[want % 3].load(std::memory_order_acquire) == want);
+	if(warmup > 0)
+		warmup--;
+	else if((tailCount > 0) && !tailReady)
+		misses++;
+}
+
+void partitionedConvolver::process(const float* in, float* out, int sampleCount)
+{
+	if(headLength == 0)
+	{
+		memset(out, 0, sampleCount * sizeof(float));
+		return;
+	}
+
+	int i = 0;
+	while(i < sampleCount)
+	{
+		int run = sampleCount - i;
+		if(run > partition - position)
+			run = partition - position;
+		const float* tail = tailReady ? tailOutput + (((period - tailLag + CONV_JOB_WRAP) % CONV_JOB_WRAP) % 3) * partition + position : NULL;
+		float* collect = (tailCount > 0) ? inputBuffer + partition + position : NULL;
+
+		for(int n=0;n<run;n++)
+		{
+			float x = in[i+n];
+
+			//head: mirrored ring, the last headLength inputs are contiguous from the oldest to the newest
+			int w = headIndex;
+			headHistory[w] = x;
+			headHistory[w + headLength] = x;
+			const float* window = headHistory + w + 1;
+			headIndex = (w + 1 == headLength) ? 0 : w + 1;
+			float y;
+#ifdef CONV_USE_DSPS
+			dsps_dotprod_f32(headTaps, window, &y, headLength);
+#else
+			float s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+			int t = 0;
+			for(;t<headLength-3;t+=4)
+			{
+				s0 += headTaps[t] * window[t];
+				s1 += headTaps[t+1] * window[t+1];
+				s2 += headTaps[t+2] * window[t+2];
+				s3 += headTaps[t+3] * window[t+3];
+			}
+			for(;t<headLength;t++)
+				s0 += headTaps[t] * window[t];
+			y = (s0 + s1) + (s2 + s3);
+#endif
+
+			if(collect != NULL)
+				collect[n] = x;
+			if(tail != NULL)
+				y += tail[n];
+			out[i+n] = y;
+		}
+
+		position += run;
+		i += run;
+		if(position == partition)
+			endPartition();
+	}
+}
+
+//######################################################################
+// WINDOWS
+// hann and hamming interpolate the 256-point tables (the one behind hann_table),
+// blackman-harris a 1024-interval table for its -92 dB side lobes
+
+float makeWindow(float* window, int size, FFT_WINDOW type)
+{
+  float sum = 0;
+  for(int i=0;i<size;i++)
+  {
+    float x = (float)i / (float)size;
+    float w;
+    switch(type)
+    {
+      case FW_HANN:
+        w = tableLookup(sharedTable<hannShape, float, 255>::table, x);
+        break;
+      case FW_HAMMING:
+        w = tableLookup(sharedTable<hammingShape, float, 255>::table, x);
+        break;
+      case FW_BLACKMAN_HARRIS:
+        w = tableLookup(sharedTable<blackmanHarrisShape, float, 1024>::table, x);
+        break;
+      default:
+        w = 1.0f;
+        break;
+    }
+    window[i] = w;
+    sum += w;
+  }
+  return sum;
+}
+
+//######################################################################
+// ANALYSIS RING
+
+analysisRing::analysisRing()
+{
+	buffer = NULL;
+	mask = 0;
+	decimation = 1;
+	clear();
+}
+
+analysisRing::~analysisRing()
+{
+	delete[] buffer;
+}
+
+bool analysisRing::init(int capacity, int decimationFactor)
+{
+	delete[] buffer;
+	unsigned int length = 16;
+	while(length < (unsigned int)capacity)
+		length <<= 1;
+	buffer = new float[length];
+	if(buffer == NULL)
+	{
+		mask = 0;
+		return false;
+	}
+	mask = length - 1;
+	decimation = (decimationFactor < 1) ? 1 : decimationFactor;
+	clear();
+	return true;
+}
+
+void analysisRing::clear()
+{
+	phase = 0;
+	sum = 0;
+	written.store(0, std::memory_order_release);
+}
+
+void analysisRing::write(const float* in, int sampleCount)
+{
+	if(buffer == NULL)
+		return;
+	unsigned int w = written.load(std::memory_order_relaxed);
+	if(decimation == 1)
+	{
+		int i = 0;
+		while(i < sampleCount)
+		{
+			unsigned int index = w & mask;
+			int run = sampleCount - i;
+			if((unsigned int)run > mask + 1 - index)
+				run = mask + 1 - index;
+			memcpy(buffer + index, in + i, run * sizeof(float));
+			w += run;
+			i += run;
+		}
+	}
+	else
+	{
+		//box-car average: a cheap anti-alias before keeping one sample of decimation
+		float s = sum;
+		int p = phase;
+		float average = 1.0f / (float)decimation;
+		for(int i=0;i<sampleCount;i++)
+		{
+			s += in[i];
+			if(++p == decimation)
+			{
+				buffer[w & mask] = s * average;
+				w++;
+				s = 0;
+				p = 0;
+			}
+		}
+		sum = s;
+		phase = p;
+	}
+	written.store(w, std::memory_order_release);
+}
+
+void analysisRing::writeInterleaved(const int32_t* frame, int sampleCount, int channel)
+{
+	if(buffer == NULL)
+		return;
+	const int32_t* in = frame + channel;
+	const float scale = 1.0f / 2147483648.0f;
+	unsigned int w = written.load(std::memory_order_relaxed);
+	if(decimation == 1)
+	{
+		for(int i=0;i<sampleCount;i++)
+			buffer[(w + i) & mask] = scale * (float)in[2*i];
+		w += sampleCount;
+	}
+	else
+	{
+		float s = sum;
+		int p = phase;
+		float average = scale / (float)decimation;
+		for(int i=0;i<sampleCount;i++)
+		{
+			s += (float)in[2*i];
+			if(++p == decimation)
+			{
+				buffer[w & mask] = s * average;
+				w++;
+				s = 0;
+				p = 0;
+			}
+		}
+		sum = s;
+		phase = p;
+	}
+	written.store(w, std::memory_order_release);
+}
+
+bool analysisRing::read(float* dest, int count, unsigned int end)
+{
+	unsigned int capacity = mask + 1;
+	//the producer may be writing up to one block beyond the published count
+	unsigned int margin = MAX_AUDIO_BLOCK / decimation + 1;
+	if((buffer == NULL) || ((unsigned int)count + margin > capacity))
+		return false;
+	unsigned int start = end - count;
+	if(written.load(std::memory_order_acquire) - start + margin > capacity)
+		return false;
+
+	unsigned int index = start & mask;
+	unsigned int first = capacity - index;
+	if(first > (unsigned int)count)
+		first = count;
+	memcpy(dest, buffer + index, first * sizeof(float));
+	memcpy(dest + first, buffer, (count - first) * sizeof(float));
+
+	//rejected if the producer reached the copied part in the meantime
+	std::atomic_thread_fence(std::memory_order_acquire);
+	return written.load(std::memory_order_relaxed) - start + margin <= capacity;
+}
+
+bool analysisRing::readLatest(float* dest, int count)
+{
+	unsigned int end = getWriteCount();
+	if(end < (unsigned int)count)
+		return false;
+	return read(dest, count, end);
+}
+
+//######################################################################
+// SPECTRUM ANALYZER
+
+//below the control and the BLE tasks, the analysis uses the spare time of core 0
+#define SPECTRUM_TASK_PRIORITY	1
+
+spectrumAnalyzer::spectrumAnalyzer()
+{
+	fft = NULL;
+	size = 0;
+	hop = 0;
+	lastEnd = 0;
+	window = NULL;
+	frame = NULL;
+	magnitudes = NULL;
+	scale = 0;
+	binWidth = 0;
+	peakFrequency = 0;
+	sequence = 0;
+	spectrumCount = 0;
+	task = NULL;
+	taskInterval = 50;
+}
+
+spectrumAnalyzer::~spectrumAnalyzer()
+{
+#ifdef ARDUINO_ARCH_ESP32
+	if(task != NULL)
+		vTaskDelete((TaskHandle_t)task);
+#endif
+	delete fft;
+	delete[] window;
+	delete[] frame;
+	delete[] magnitudes;
+}
+
+bool spectrumAnalyzer::init(int fftSize, int decimation, FFT_WINDOW windowType)
+{
+	if((fftSize < 64) || (fftSize > 4096) || (fftSize & (fftSize-1)))
+		return false;
+	delete fft;
+	delete[] window;
+	delete[] frame;
+	delete[] magnitudes;
+	size = fftSize;
+	fft = new realFFT(size);
+	window = new float[size];
+	frame = new float[size];
+	magnitudes = new float[size/2 + 1];
+	//two frames, plus the block in flight
+	if((fft == NULL) || (window == NULL) || (frame == NULL) || (magnitudes == NULL)
+		|| !ring.init(2 * size + MAX_AUDIO_BLOCK, decimation))
+		return false;
+
+	scale = 2.0f / makeWindow(window, size, windowType);
+	binWidth = (float)SAMPLE_RATE / (float)ring.getDecimation() / (float)size;
+	memset(magnitudes, 0, (size/2 + 1) * sizeof(float));
+	hop = size/2;
+	lastEnd = 0;
+	peakFrequency = 0;
+	sequence = 0;
+	spectrumCount = 0;
+	return true;
+}
+
+void spectrumAnalyzer::setHop(int samples)
+{
+	if(samples < 1) samples = 1;
+	hop = samples;
+}
+
+bool spectrumAnalyzer::update()
+{
+	if(fft == NULL)
+		return false;
+	unsigned int end = ring.getWriteCount();
+	if((end < (unsigned int)size) || (end - lastEnd < (unsigned int)hop))
+		return false;
+	bool valid = ring.read(frame, size, end);
+	lastEnd = end;
+	if(!valid)
+		return false;
+
+	for(int i=0;i<size;i++)
+		frame[i] *= window[i];
+	fft->forward(frame, frame);
+
+	//seqlock: odd sequence while the magnitudes change
+	int half = size/2;
+	unsigned int seq = sequence.load(std::memory_order_relaxed);
+	sequence.store(seq + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+	magnitudes[0] = 0.5f * scale * fabsf(frame[0]);
+	magnitudes[half] = 0.5f * scale * fabsf(frame[1]);
+	int peakBin = 1;
+	for(int k=1;k<half;k++)
+	{
+		float re = frame[2*k];
+		float im = frame[2*k+1];
+		float m = scale * sqrtf(re * re + im * im);
+		magnitudes[k] = m;
+		if(m > magnitudes[peakBin])
+			peakBin = k;
+	}
+	sequence.store(seq + 2, std::memory_order_release);
+
+	//parabola through the log magnitudes around the peak
+	float offset = 0;
+	if((peakBin > 1) && (peakBin < half - 1) && (magnitudes[peakBin] > 0))
+	{
+		float a = logf(magnitudes[peakBin-1] + 1.0e-20f);
+		float b = logf(magnitudes[peakBin]);
+		float c = logf(magnitudes[peakBin+1] + 1.0e-20f);
+		float d = a - 2.0f * b + c;
+		if(d < 0)
+			offset = 0.5f * (a - c) / d;
+	}
+	peakFrequency = ((float)peakBin + offset) * binWidth;
+	spectrumCount.fetch_add(1, std::memory_order_release);
+	return true;
+}
+
+bool spectrumAnalyzer::getMagnitudes(float* dest)
+{
+	if(spectrumCount.load(std::memory_order_acquire) == 0)
+		return false;
+	for(int tries=0;tries<8;tries++)
+	{
+		unsigned int seq = sequence.load(std::memory_order_acquire);
+		if(seq & 1)
+			continue;
+		memcpy(dest, magnitudes, (size/2 + 1) * sizeof(float));
+		std::atomic_thread_fence(std::memory_order_acquire);
+		if(sequence.load(std::memory_order_relaxed) == seq)
+			return true;
+	}
+	return false;
+}
+
+#ifdef ARDUINO_ARCH_ESP32
+void spectrumAnalyzer::taskLoop(void* arg)
+{
+	spectrumAnalyzer* analyzer = (spectrumAnalyzer*)arg;
+	while(true)
+	{
+		analyzer->update();
+		vTaskDelay(analyzer->taskInterval);
+	}
+}
+
+bool spectrumAnalyzer::startTask(int intervalMs)
+{
+	if((fft == NULL) || (task != NULL))
+		return false;
+	taskInterval = (intervalMs < 1) ? 1 : intervalMs;
+	TaskHandle_t handle = NULL;
+	xTaskCreatePinnedToCore(taskLoop, "spectrum_task", 4096, this, SPECTRUM_TASK_PRIORITY, &handle, 0);
+	task = handle;
+	return task != NULL;
+}
+#else
+void spectrumAnalyzer::taskLoop(void* arg)
+{
+}
+
+bool spectrumAnalyzer::startTask(int intervalMs)
+{
+	return false;
+}
+#endif
+
+//######################################################################
+// PITCH DETECTOR
+
+#define PITCH_MIN_LAG	2
+
+pitchDetector::pitchDetector()
+{
+	rate = SAMPLE_RATE;
+	minLag = PITCH_MIN_LAG;
+	maxLag = 0;
+	windowLength = 0;
+	frame = NULL;
+	difference = NULL;
+	threshold = 0.15f;
+	gate = 0.001f;
+	startCount = 0;
+	lastEnd = 0;
+	frequency = 0;
+	clarity = 0;
+	level = 0;
+}
+
+pitchDetector::~pitchDetector()
+{
+	delete[] frame;
+	delete[] difference;
+}
+
+bool pitchDetector::init(float minFrequency, float maxFrequency, int decimation)
+{
+	if(decimation < 1) decimation = 1;
+	rate = (float)SAMPLE_RATE / (float)decimation;
+	if((minFrequency <= 0) || (maxFrequency <= minFrequency))
+		return false;
+	maxLag = (int)ceilf(rate / minFrequency);
+	minLag = (int)floorf(rate / maxFrequency);
+	if(minLag < PITCH_MIN_LAG)
+		minLag = PITCH_MIN_LAG;
+	if(maxLag <= minLag + 2)
+		return false;
+	windowLength = maxLag;
+
+	delete[] frame;
+	delete[] difference;
+	int length = windowLength + maxLag + 1;
+	frame = new float[length];
+	difference = new float[maxLag + 2];
+	//one frame, plus the block in flight
+	if((frame == NULL) || (difference == NULL)
+		|| !ring.init(length + MAX_AUDIO_BLOCK + MAX_AUDIO_BLOCK / decimation + 1, decimation))
+		return false;
+	reset();
+	return true;
+}
+
+void pitchDetector::reset()
+{
+	startCount = ring.getWriteCount();
+	lastEnd = startCount;
+	frequency = 0;
+	clarity = 0;
+	level = 0;
+}
+
+bool pitchDetector::update()
+{
+	if(frame == NULL)
+		return false;
+	int length = windowLength + maxLag + 1;
+	unsigned int end = ring.getWriteCount();
+	if((end - startCount < (unsigned int)length) || (end == lastEnd))
+		return false;
+	bool valid = ring.read(frame, length, end);
+	lastEnd = end;
+	if(!valid)
+		return false;
+
+	//energy of the window at lag 0, the gate
+	float e0 = 0;
+	for(int j=0;j<windowLength;j++)
+		e0 += frame[j] * frame[j];
+	level = sqrtf(e0 / (float)windowLength);
+	if(level < gate)
+	{
+		frequency = 0;
+		clarity = 0;
+		return true;
+	}
+
+	//difference function d(tau) = e(0) + e(tau) - 2 r(tau),
+	//with the energy e(tau) of the lagged window updated incrementally
+	float et = e0;
+	for(int tau=1;tau<=maxLag+1;tau++)
+	{
+		float x0 = frame[tau-1];
+		float x1 = frame[tau-1+windowLength];
+		et += x1 * x1 - x0 * x0;
+		const float* lagged = frame + tau;
+		float r;
+#ifdef CONV_USE_DSPS
+		dsps_dotprod_f32(frame, lagged, &r, windowLength);
+#else
+		float s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+		int j = 0;
+		for(;j<windowLength-3;j+=4)
+		{
+			s0 += frame[j] * lagged[j];
+			s1 += frame[j+1] * lagged[j+1];
+			s2 += frame[j+2] * lagged[j+2];
+			s3 += frame[j+3] * lagged[j+3];
+		}
+		for(;j<windowLength;j++)
+			s0 += frame[j] * lagged[j];
+		r = (s0 + s1) + (s2 + s3);
+#endif
+		float d = e0 + et - 2.0f * r;
+		difference[tau] = (d > 0) ? d : 0;
+	}
+
+	//cumulative mean normalization
+	difference[0] = 1;
+	float running = 0;
+	for(int tau=1;tau<=maxLag+1;tau++)
+	{
+		running += difference[tau];
+		difference[tau] = (running > 0) ? difference[tau] * (float)tau / running : 1;
+	}
+
+	//the first dip below the threshold, followed down to its minimum
+	int best = 0;
+	for(int tau=minLag;tau<=maxLag;tau++)
+	{
+		if(difference[tau] < threshold)
+		{
+			while((tau < maxLag) && (difference[tau+1] < difference[tau]))
+				tau++;
+			best = tau;
+			break;
+		}
+	}
+	if(best == 0)
+	{
+		float lowest = 1;
+		for(int tau=minLag;tau<=maxLag;tau++)
+			if(difference[tau] < lowest)
+				lowest = difference[tau];
+		frequency = 0;
+		clarity = (lowest < 1) ? 1 - lowest : 0;
+		return true;
+	}
+
+	//parabola through the normalized difference around the dip
+	float a = difference[best-1];
+	float b = difference[best];
+	float c = difference[best+1];
+	float offset = 0;
+	float curvature = a - 2.0f * b + c;
+	if(curvature > 0)
+		offset = 0.5f * (a - c) / curvature;
+	frequency = rate / ((float)best + offset);
+	clarity = (b < 1) ? 1 - b : 0;
+	return true;
+}
@@ -0,0 +1,261 @@
+/*!
+ *  @file       bsfft.h
+ *  Project     Blackstomp Arduino Library
+ *  @brief      Blackstomp Library for the Arduino
+ *  @author     Hasan Murod
+ *  @date       17/10/2026
+ *  @license    MIT - Copyright (c) 2020 Hasan Murod
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#ifndef BSFFT_H_
+#define BSFFT_H_
+
+#include <stdint.h>
+#include <atomic>
+
+//FFT BASED PROCESSING
+//the spectra are packed in the usual real FFT layout of size floats:
+//[0] = bin 0 (dc), [1] = bin size/2 (nyquist), [2k], [2k+1] = real and imaginary part of bin k (k = 1 .. size/2-1)
+
+//real FFT of a power of two size (16 .. 4096, rounded up) with precomputed twiddles,
+//computed as a half-size complex FFT (ESP-DSP's radix-2 kernel when it's available) and a split step,
+//the tables are allocated by the constructor, so create it in init(), not in process()
+class realFFT
+{
+  private:
+    int size;
+    int half;           //complex FFT size
+    float* twiddles;    //half/2 complex, exp(-2.pi.i.k/half)
+    float* split;       //half/2+1 complex, exp(-2.pi.i.k/size)
+    uint16_t* swaps;    //bit reversal pairs
+    int swapCount;
+    void complexFFT(float* data);
+  public:
+  realFFT(int fftSize);
+  ~realFFT();
+  int getSize(){return size;}
+  //packed spectrum of size real samples, in place allowed
+  void forward(const float* in, float* out);
+  //size real samples from a packed spectrum, scaled so that inverse(forward(x)) = x, in place allowed
+  void inverse(const float* in, float* out);
+};
+
+//analysis windows, from the compile-time shape tables of lookuptable.h (the shape of hann_table and its relatives)
+typedef enum
+{
+  FW_RECTANGULAR,
+  FW_HANN,
+  FW_HAMMING,
+  FW_BLACKMAN_HARRIS
+}
+FFT_WINDOW;
+
+//periodic window of size points (w[size] would be w[0]), returns the sum of the points (the coherent gain x size)
+float makeWindow(float* window, int size, FFT_WINDOW type);
+
+//zero-latency convolution for long impulse responses (e.g. cabinets, 1024-2048 taps),
+//the head of the IR is convolved in the time domain sample by sample,
+//the tail in uniform partitions of partitionSize taps by overlap-save FFT blocks (FFT size 2 x partitionSize),
+//the tail work runs once per partition: inline in process() (head: partitionSize taps)
+//or, with tailOnCore0, in a task on core 0 with a deadline of one partition (head: 2 x partitionSize taps),
+//the IR spectra are stored in PSRAM when available, the input spectra and the head in internal RAM
+#define CONV_MIN_PARTITION  16
+#define CONV_MAX_PARTITION  1024
+class partitionedConvolver
+{
+	private:
+	int partition;        //P, tail partition length
+	int headLength;       //taps convolved in the time domain
+	int tailLag;          //partitions between a tail job and its output (1 inline, 2 on core 0)
+	int tailCount;        //tail partitions
+	float* headTaps;      //reversed head taps
+	float* headHistory;   //2 x headLength, mirrored ring of the last inputs
+	int headIndex;
+	realFFT* fft;
+	float* irSpectra;     //tailCount packed spectra of 2P
+	float* inputSpectra;  //tailCount packed spectra of 2P, frequency-domain delay line
+	float* accumulator;   //2P
+	float* inputBuffer;   //2P: the previous and the current input partition
+	float* jobInput;      //2P: copy of inputBuffer for the core-0 job
+	float* tailOutput;    //3 x P output slots, slot = job number % 3
+	std::atomic<int> slotJob[3];  //job number written in each slot
+	int fdlIndex;         //input spectrum of the last job
+	int position;         //samples into the current partition
+	int period;           //current partition number
+	bool tailReady;       //the tail output of the current partition is valid
+	int warmup;           //partitions before the first tail output
+	unsigned int misses;
+	std::atomic<int> posted;    //last job number posted by process()
+	std::atomic<int> finished;  //last job number finished by the tail job
+	int lastJob;          //last job number processed by the tail job
+	void* task;
+	std::atomic<bool> stopTask;
+	static void taskLoop(void* arg);
+	void runTail(const float* in, int job);
+	void endPartition();
+	void release();
+
+	public:
+	partitionedConvolver();
+	~partitionedConvolver();
+	//copies the IR, partitionSize: power of two, CONV_MIN_PARTITION .. CONV_MAX_PARTITION,
+	//returns false if the memory allocation fails or the parameters are invalid
+	bool init(const float* ir, int irLength, int partitionSize=128, bool tailOnCore0=false);
+	void reset();
+	//in place allowed
+	void process(const float* in, float* out, int sampleCount);
+	//partitions whose core-0 tail output was not ready in time (the tail is skipped for that partition)
+	unsigned int getTailMissCount(){return misses;}
+};
+
+//lock-free single-producer single-consumer ring of decimated samples for the analysis off the audio core,
+//the audio task writes each block once (a copy, or an average of decimation samples per stored sample),
+//the consumer (e.g. a core-0 task) copies out the latest samples whenever it is ready,
+//a copy that was overwritten during the read is rejected, the producer never waits
+class analysisRing
+{
+	private:
+	float* buffer;
+	unsigned int mask;      //capacity - 1 (power of two)
+	int decimation;
+	int phase;              //samples in the running average
+	float sum;
+	std::atomic<unsigned int> written;  //total stored samples
+	
+	public:
+	analysisRing();
+	~analysisRing();
+	//capacity in stored (decimated) samples, rounded up to a power of two
+	bool init(int capacity, int decimationFactor=1);
+	int getDecimation(){return decimation;}
+	//producer side (audio task)
+	void write(const float* in, int sampleCount);
+	//producer side for a raw i2s frame: one channel (0: left, 1: right) of sampleCount stereo interleaved
+	//32-bit samples (24-bit left-justified), scaled to 1.0 like the frame processor's conversion
+	void writeInterleaved(const int32_t* frame, int sampleCount, int channel);
+	//consumer side: total stored samples so far, the read position of the newest data
+	unsigned int getWriteCount(){return written.load(std::memory_order_acquire);}
+	//copy the count samples stored before end, false if they are not (or no longer) in the ring
+	bool read(float* dest, int count, unsigned int end);
+	//copy the latest count samples
+	bool readLatest(float* dest, int count);
+	void clear();
+};
+
+//magnitude spectrum of an audio stream, computed off the audio core:
+//write() each block from process(), update() from another task (or startTask() on core 0),
+//the magnitudes are scaled so that a sine of amplitude A gives A at its bin,
+//readers on other tasks get a consistent copy through getMagnitudes()
+class spectrumAnalyzer
+{
+	private:
+	realFFT* fft;
+	analysisRing ring;
+	int size;
+	int hop;                  //new samples needed for the next spectrum
+	unsigned int lastEnd;     //ring position of the last spectrum
+	float* window;
+	float* frame;
+	float* magnitudes;        //size/2+1 bins
+	float scale;
+	float binWidth;           //Hz
+	float peakFrequency;
+	std::atomic<unsigned int> sequence;  //odd while the magnitudes are being written
+	std::atomic<unsigned int> spectrumCount;
+	void* task;
+	int taskInterval;
+	static void taskLoop(void* arg);
+	
+	public:
+	spectrumAnalyzer();
+	~spectrumAnalyzer();
+	//fftSize: 64 .. 4096, power of two, the analysed sample rate is SAMPLE_RATE / decimation
+	bool init(int fftSize, int decimation=1, FFT_WINDOW windowType=FW_HANN);
+	//new (decimated) samples between two spectra, default fftSize/2 (50% overlap)
+	void setHop(int samples);
+	//audio task side: one copy per block
+	void write(const float* in, int sampleCount){ring.write(in, sampleCount);}
+	//analysis side: computes a new spectrum if a hop of new samples is available, returns true if it did
+	bool update();
+	//run update() every intervalMs in a low priority task on core 0 (device only, returns false on the host)
+	bool startTask(int intervalMs=50);
+	
+	int getBinCount(){return size/2 + 1;}
+	float getBinFrequency(int bin){return bin * binWidth;}
+	//copy of the latest magnitudes (getBinCount() values), false if there is no spectrum yet
+	bool getMagnitudes(float* dest);
+	//frequency of the strongest bin above dc, refined by parabolic interpolation
+	float getPeakFrequency(){return peakFrequency;}
+	//number of spectra computed so far
+	unsigned int getSpectrumCount(){return spectrumCount.load(std::memory_order_acquire);}
+};
+
+//monophonic pitch detection (e.g. for a tuner) off the audio core, fed like spectrumAnalyzer:
+//write() each block from the audio task, update() from another task,
+//YIN: difference function over a window of one longest period, cumulative mean normalization,
+//the first dip below the threshold, refined by parabolic interpolation,
+//the latest samples are analysed at each update(): the latency is the window plus the update interval
+class pitchDetector
+{
+	private:
+	analysisRing ring;
+	float rate;               //analysed sample rate
+	int minLag;
+	int maxLag;
+	int windowLength;         //integration window, maxLag
+	float* frame;             //windowLength + maxLag + 1 samples
+	float* difference;        //maxLag + 2 values
+	float threshold;
+	float gate;
+	unsigned int startCount;  //ring position of reset()
+	unsigned int lastEnd;
+	float frequency;
+	float clarity;
+	float level;
+	
+	public:
+	pitchDetector();
+	~pitchDetector();
+	//range of the fundamental, the analysed sample rate is SAMPLE_RATE / decimation
+	bool init(float minFrequency=60, float maxFrequency=1400, int decimation=2);
+	//cumulative mean normalized difference threshold, lower is stricter, default 0.15
+	void setThreshold(float value){threshold = value;}
+	//rms level of the window below which no pitch is reported, default 0.001 (-60 dBFS)
+	void setGate(float rms){gate = rms;}
+	//audio task side: one copy per block
+	void write(const float* in, int sampleCount){ring.write(in, sampleCount);}
+	void writeInterleaved(const int32_t* frame, int sampleCount, int channel){ring.writeInterleaved(frame, sampleCount, channel);}
+	//analysis side: forget the result and the samples written so far (e.g. when the producer restarts)
+	void reset();
+	//analyses the latest window if new samples are available, returns true if it did
+	bool update();
+	//fundamental frequency in Hz of the last update(), 0 if no pitch was found
+	float getFrequency(){return frequency;}
+	//periodicity of the last window, 0 .. 1 (1 - the normalized difference at the detected period)
+	float getClarity(){return clarity;}
+	//rms level of the last window
+	float getLevel(){return level;}
+	//length of the analysed window in milliseconds
+	float getWindowTime(){return 1000.0f * (float)(windowLength + maxLag + 1) / rate;}
+};
+
+#endif
@@ -0,0 +1,340 @@
+/*!
+ *  @file       bsfixed.cpp
+ *  Project     Blackstomp Arduino Library
+ *  @brief      Blackstomp Library for the Arduino
+ *  @author     Hasan Murod
+ *  @date       17/10/2026
+ *  @license    MIT - Copyright (c) 2020 Hasan Murod
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#include "bsfixed.h"
+#include "blackstomp.h"
+#include <math.h>
+
+//######################################################################
+// BIQUAD FILTER Q31
+// direct-form-1: the states are the past inputs and outputs (full scale q31),
+// the 64-bit accumulator holds five products of a q31 sample and a coefficient in Q(shift),
+// it can't overflow as long as the sum of |coefficients| stays below 2^(32-shift),
+// so each stage gets the largest shift (at most 30) that satisfies this and fits its largest coefficient in 32 bits
+
+#define BIQUAD_Q31_MAX_SHIFT 30
+#define BIQUAD_Q31_MIN_SHIFT 22
+
+struct biquadStateQ31
+{
+  int32_t coef[5];  //b0, b1, b2, a1, a2 in Q(shift)
+  int shift;        //fractional bits of the coefficients, 30 unless the stage needs the range (e.g. boosting shelf or peak)
+  q31_t x[2];
+  q31_t y[2];
+};
+
+biquadFilterQ31::biquadFilterQ31(int stageCount)
+{
+  stages = stageCount;
+  biquadStateQ31* s = new biquadStateQ31[stages];
+  states = (void*) s;
+  for(int i=0;i<stages;i++)
+  {
+    for(int n=0;n<5;n++)
+      s[i].coef[n] = 0;
+    s[i].shift = BIQUAD_Q31_MAX_SHIFT;
+  }
+  reset();
+}
+
+biquadFilterQ31::~biquadFilterQ31()
+{
+  biquadStateQ31* sp = (biquadStateQ31*) states;
+  delete[] sp;
+}
+
+bool biquadFilterQ31::setCoef(const float* coef)
+{
+  biquadStateQ31* sp = (biquadStateQ31*) states;
+  bool inRange = true;
+  for(int i=0;i<stages;i++)
+  {
+    const float* c = coef + (5*i);
+    float sum = 0;
+    float peak = 0;
+    for(int n=0;n<5;n++)
+    {
+      sum += fabsf(c[n]);
+      if(fabsf(c[n]) > peak) peak = fabsf(c[n]);
+    }
+    
+    //the largest shift with sum < 2^(32-shift) and peak < 2^(31-shift)
+    int shift = BIQUAD_Q31_MAX_SHIFT;
+    while((shift > BIQUAD_Q31_MIN_SHIFT) && ((sum >= ldexpf(1.0f, 32-shift)) || (peak >= ldexpf(1.0f, 31-shift))))
+      shift--;
+    if((sum >= ldexpf(1.0f, 32-shift)) || (peak >= ldexpf(1.0f, 31-shift)))
+      inRange = false;
+    
+    sp[i].shift = shift;
+    for(int n=0;n<5;n++)
+    {
+      float v = ldexpf(c[n], shift);
+      if(v > 2147483520.0f) v = 2147483520.0f;  //largest float below 2^31
+      if(v < -2147483648.0f) v = -2147483648.0f;
+      sp[i].coef[n] = (int32_t)lrintf(v);
+    }
+  }
+  return inRange;
+}
+
+void biquadFilterQ31::reset()
+{
+  biquadStateQ31* sp = (biquadStateQ31*) states;
+  for(int i=0;i<stages;i++)
+  {
+    sp[i].x[0]=0;
+    sp[i].x[1]=0;
+    sp[i].y[0]=0;
+    sp[i].y[1]=0;
+  }
+}
+
+q31_t biquadFilterQ31::process(q31_t in)
+{
+  biquadStateQ31* sp = (biquadStateQ31*) states;
+  q31_t input = in;
+  for(int s=0;s<stages;s++)
+  {
+    int64_t acc = (int64_t)sp[s].coef[0] * input 
+      + (int64_t)sp[s].coef[1] * sp[s].x[0] + (int64_t)sp[s].coef[2] * sp[s].x[1]
+      + (int64_t)sp[s].coef[3] * sp[s].y[0] + (int64_t)sp[s].coef[4] * sp[s].y[1];
+    int shift = sp[s].shift;
+    q31_t output = q31Saturate((acc + ((int64_t)1 << (shift - 1))) >> shift);
+    sp[s].x[1] = sp[s].x[0];
+    sp[s].x[0] = input;
+    sp[s].y[1] = sp[s].y[0];
+    sp[s].y[0] = output;
+    input = output;
+  }
+  return input;
+}
+
+void biquadFilterQ31::process(const q31_t* in, q31_t* out, int sampleCount, int stride)
+{
+  biquadStateQ31* sp = (biquadStateQ31*) states;
+  int length = sampleCount * stride;
+  for(int s=0;s<stages;s++)
+  {
+    //one stage over the whole block, the states stay in registers
+    const q31_t* src = (s == 0) ? in : out;
+    int64_t b0 = sp[s].coef[0], b1 = sp[s].coef[1], b2 = sp[s].coef[2];
+    int64_t a1 = sp[s].coef[3], a2 = sp[s].coef[4];
+    int shift = sp[s].shift;
+    int64_t round = (int64_t)1 << (shift - 1);
+    q31_t x1 = sp[s].x[0], x2 = sp[s].x[1];
+    q31_t y1 = sp[s].y[0], y2 = sp[s].y[1];
+    for(int i=0;i<length;i+=stride)
+    {
+      q31_t x0 = src[i];
+      int64_t acc = b0 * x0 + b1 * x1 + b2 * x2 + a1 * y1 + a2 * y2;
+      q31_t y0 = q31Saturate((acc + round) >> shift);
+      x2 = x1;
+      x1 = x0;
+      y2 = y1;
+      y1 = y0;
+      out[i] = y0;
+    }
+    sp[s].x[0] = x1;
+    sp[s].x[1] = x2;
+    sp[s].y[0] = y1;
+    sp[s].y[1] = y2;
+  }
+}
+
+//######################################################################
+// RC LOW-PASS AND HIGH-PASS FILTER Q31
+// vc = vc + k.(in - vc), k = 1/(tc x sample rate) is computed once in the setters
+
+static q31_t rcCoefQ31(float tc)
+{
+	float k = 1.0f/(tc * SAMPLE_RATE);
+	return floatToQ31(k);
+}
+
+static inline q31_t rcUpdateQ31(q31_t vc, q31_t in, q31_t k)
+{
+	int64_t delta = ((((int64_t)in - vc) * k) + (1 << 30)) >> 31;
+	return (q31_t)(vc + delta);
+}
+
+rcLoPassQ31::rcLoPassQ31()
+{
+	vc=0;
+	setCutOff(1000);
+}
+
+void rcLoPassQ31::setTimeConstant(float val)
+{
+	k = rcCoefQ31(val);
+}
+
+void rcLoPassQ31::setCutOff(float val)
+{
+	k = rcCoefQ31(1/(6.283*val));
+}
+
+q31_t rcLoPassQ31::process(q31_t in)
+{
+	vc = rcUpdateQ31(vc, in, k);
+	return vc;
+}
+
+void rcLoPassQ31::process(const q31_t* in, q31_t* out, int sampleCount, int stride)
+{
+	q31_t v = vc;
+	int length = sampleCount * stride;
+	for(int i=0;i<length;i+=stride)
+	{
+		v = rcUpdateQ31(v, in[i], k);
+		out[i] = v;
+	}
+	vc = v;
+}
+
+rcHiPassQ31::rcHiPassQ31()
+{
+	vc=0;
+	setCutOff(20);
+}
+
+void rcHiPassQ31::setTimeConstant(float val)
+{
+	k = rcCoefQ31(val);
+}
+
+void rcHiPassQ31::setCutOff(float val)
+{
+	k = rcCoefQ31(1/(6.283*val));
+}
+
+q31_t rcHiPassQ31::process(q31_t in)
+{
+	vc = rcUpdateQ31(vc, in, k);
+	return q31Saturate((int64_t)in - vc);
+}
+
+void rcHiPassQ31::process(const q31_t* in, q31_t* out, int sampleCount, int stride)
+{
+	q31_t v = vc;
+	int length = sampleCount * stride;
+	for(int i=0;i<length;i+=stride)
+	{
+		q31_t x = in[i];
+		v = rcUpdateQ31(v, x, k);
+		out[i] = q31Saturate((int64_t)x - v);
+	}
+	vc = v;
+}
+
+//######################################################################
+// DELAY LINE Q15
+delayLineQ15::delayLineQ15()
+{
+	buffer = NULL;
+	mask = 0;
+	writeIndex = 0;
+}
+
+delayLineQ15::~delayLineQ15()
+{
+	if(buffer != NULL)
+		delete[] buffer;
+}
+
+bool delayLineQ15::init(int maxDelaySamples)
+{
+	if(buffer != NULL)
+		return false;
+	
+	//power of two length with room for the interpolation point
+	int length = 2;
+	while(length < maxDelaySamples + 2)
+		length <<= 1;
+	buffer = new q15_t[length];
+	if(buffer == NULL)
+		return false;
+	mask = length - 1;
+	for(int i=0;i<length;i++)
+		buffer[i] = 0;
+	return true;
+}
+
+void delayLineQ15::write(q31_t sample)
+{
+	writeIndex = (writeIndex + 1) & mask;
+	buffer[writeIndex] = q31ToQ15(sample);
+}
+
+q31_t delayLineQ15::read(int delaySamples)
+{
+	return q15ToQ31(buffer[(writeIndex - delaySamples) & mask]);
+}
+
+q31_t delayLineQ15::read(int32_t delayQ16, bool interpolate)
+{
+	int index = writeIndex - (delayQ16 >> 16);
+	int32_t s0 = buffer[index & mask];
+	if(!interpolate)
+		return q15ToQ31(s0);
+	int32_t s1 = buffer[(index - 1) & mask];
+	int32_t frac = delayQ16 & 0xFFFF;
+	//s0 + frac.(s1 - s0) in Q31
+	return (q31_t)(((int64_t)s0 << 16) + (int64_t)(s1 - s0) * frac);
+}
+
+//######################################################################
+// WAVESHAPER Q31
+waveShaperQ31::waveShaperQ31()
+{
+	//initialize the transfer function table with the default function of waveShaper
+	setTransferFunction(sharedTable<tanhShape<3>, float, 255>::table.data);
+}
+
+void waveShaperQ31::setTransferFunction(const float* table)
+{
+	for(int i=0;i<256;i++)
+		transferFunctionTable[i] = floatToQ31(table[i]);
+}
+
+q31_t waveShaperQ31::process(q31_t in)
+{
+	//table position = (in + 1.0) x 127.5 as 8.32 fixed-point, the index never exceeds 254
+	uint64_t pos = (uint64_t)((uint32_t)in ^ 0x80000000u) * 255;
+	int index = (int)(pos >> 32);
+	int64_t frac = (int64_t)((pos >> 16) & 0xFFFF);
+	int64_t y0 = transferFunctionTable[index];
+	int64_t y1 = transferFunctionTable[index+1];
+	return (q31_t)(y0 + (((y1 - y0) * frac) >> 16));
+}
+
+void waveShaperQ31::process(const q31_t* in, q31_t* out, int sampleCount, int stride)
+{
+	int length = sampleCount * stride;
+	for(int i=0;i<length;i+=stride)
+		out[i] = process(in[i]);
+}
@@ -0,0 +1,165 @@
+/*!
+ *  @file       bsfixed.h
+ *  Project     Blackstomp Arduino Library
+ *  @brief      Blackstomp Library for the Arduino
+ *  @author     Hasan Murod
+ *  @date       17/10/2026
+ *  @license    MIT - Copyright (c) 2020 Hasan Murod
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#ifndef BSFIXED_H_
+#define BSFIXED_H_
+
+#include <stdint.h>
+
+//FIXED-POINT DSP PRIMITIVES
+//Q31: signed 32-bit fraction (-1.0 .. 1.0-2^-31), Q15: signed 16-bit fraction
+//the 24-bit left-justified i2s samples of effectModule::processRaw() are valid Q31 values
+//all the processing is done with integer arithmetic (64-bit accumulators, saturated results),
+//so it is bit-exact between the host and the target for the same coefficients
+typedef int32_t q31_t;
+typedef int16_t q15_t;
+
+inline q31_t q31Saturate(int64_t x)
+{
+  if(x > INT32_MAX) return INT32_MAX;
+  if(x < INT32_MIN) return INT32_MIN;
+  return (q31_t)x;
+}
+
+inline q31_t floatToQ31(float x)
+{
+  if(x >= 1.0f) return INT32_MAX;
+  if(x <= -1.0f) return INT32_MIN;
+  return (q31_t)(x * 2147483648.0f);
+}
+
+inline float q31ToFloat(q31_t x)
+{
+  return (float)x * (1.0f/2147483648.0f);
+}
+
+inline q15_t q31ToQ15(q31_t x)
+{
+  //round to the nearest, saturate the positive full scale
+  int32_t y = (x >> 16) + ((x >> 15) & 1);
+  if(y > INT16_MAX) y = INT16_MAX;
+  return (q15_t)y;
+}
+
+inline q31_t q15ToQ31(q15_t x)
+{
+  return (q31_t)x << 16;
+}
+
+//a * b, rounded and saturated (only -1 * -1 overflows)
+inline q31_t q31Mul(q31_t a, q31_t b)
+{
+  return q31Saturate(((int64_t)a * b + (1 << 30)) >> 31);
+}
+
+//x * gain, gain is unsigned 16.16 fixed-point (e.g. 65536 = 1.0), saturated
+inline q31_t q31Scale(q31_t x, int32_t gainQ16)
+{
+  return q31Saturate(((int64_t)x * gainQ16) >> 16);
+}
+
+//biquad filter cascade, direct form 1 with 64-bit accumulator
+class biquadFilterQ31
+{
+  private:
+    int stages;
+    void* states;
+  public:
+  q31_t process(q31_t in);
+  //stride: distance between two samples, e.g. 2 to filter one channel of an interleaved frame
+  void process(const q31_t* in, q31_t* out, int sampleCount, int stride=1);
+  //same layout and sign convention as biquadFilter::setCoef(), coefficients are stored in Q30,
+  //a stage that needs more range (e.g. boosting shelf or peak) gets fewer fractional bits (down to Q22),
+  //returns false if a stage is out of range even then (its coefficients are saturated)
+  bool setCoef(const float* coef);
+  void reset();
+
+  biquadFilterQ31(int stageCount);
+  ~biquadFilterQ31();
+};
+
+//first order rc low-pass, no division per sample
+class rcLoPassQ31
+{
+	private:
+		q31_t vc;	//capacitor voltage
+		q31_t k;	//1/(time constant x sample rate) in Q31
+	public:
+	rcLoPassQ31();
+	void setCutOff(float val);
+	void setTimeConstant(float val);
+	q31_t process(q31_t in);
+	void process(const q31_t* in, q31_t* out, int sampleCount, int stride=1);
+};
+
+//first order rc high-pass, no division per sample
+class rcHiPassQ31
+{
+	private:
+		q31_t vc;	//capacitor voltage
+		q31_t k;	//1/(time constant x sample rate) in Q31
+	public:
+	rcHiPassQ31();
+	void setCutOff(float val);
+	void setTimeConstant(float val);
+	q31_t process(q31_t in);
+	void process(const q31_t* in, q31_t* out, int sampleCount, int stride=1);
+};
+
+//delay line storing Q15 samples (half the memory of a float delay)
+class delayLineQ15
+{
+	private:
+	q15_t* buffer;
+	int mask;	//buffer length - 1 (power of two length)
+	int writeIndex;
+	
+	public:
+	delayLineQ15();
+	~delayLineQ15();
+	bool init(int maxDelaySamples);
+	void write(q31_t sample);
+	//delay 0 is the last written sample
+	q31_t read(int delaySamples);
+	//fractional delay in 16.16 fixed-point samples, linear interpolation
+	q31_t read(int32_t delayQ16, bool interpolate);
+};
+
+//table based waveshaper, same table mapping as waveShaper (256 points over -1.0 .. 1.0)
+class waveShaperQ31
+{
+	public:
+		waveShaperQ31();
+		q31_t transferFunctionTable[256];
+		//load the table from a float table (e.g. waveShaper::transferFunctionTable)
+		void setTransferFunction(const float* table);
+		q31_t process(q31_t in);
+		void process(const q31_t* in, q31_t* out, int sampleCount, int stride=1);
+};
+
+#endif
@@ -268,118 +268,137 @@ bool AC101Codec::setI2sWordSize(uint16_t size)
 	return writeReg(I2S1LCK_CTRL, val);
 }
 
+//the module's selection while the tuner overrides the routing, the registers otherwise
+uint16_t AC101Codec::readRouting(uint8_t reg)
+{
+	if(tunerRoute == TR_OFF)
+		return readReg(reg);
+	return (reg == ADC_SRC) ? moduleAdcSrc : moduleOmixer;
+}
+
+bool AC101Codec::writeRouting(uint8_t reg, uint16_t val)
+{
+	if(tunerRoute == TR_OFF)
+		return writeReg(reg, val);
+	if(reg == ADC_SRC)
+		moduleAdcSrc = val;
+	else moduleOmixer = val;
+	return applyTunerRouting();
+}
+
 bool AC101Codec::omixerLeftLineLeft(bool select)
 {
-  uint16_t val = readReg(OMIXER_SR);
+  uint16_t val = readRouting(OMIXER_SR);
   if(select)
     val |= (uint16_t)1<<3;
   else val &= ~((uint16_t)1<<3);
-  return writeReg(OMIXER_SR, val);
+  return writeRouting(OMIXER_SR, val);
 }
 
 bool AC101Codec::omixerLeftDacLeft(bool select)
 {
-  uint16_t val = readReg(OMIXER_SR);
+  uint16_t val = readRouting(OMIXER_SR);
   if(select)
     val |= (uint16_t)1<<1;
   else val &= ~((uint16_t)1<<1);
-  return writeReg(OMIXER_SR, val);
+  return writeRouting(OMIXER_SR, val);
 }
 
 bool AC101Codec::omixerLeftMic1(bool select)
 {
-  uint16_t val = readReg(OMIXER_SR);
+  uint16_t val = readRouting(OMIXER_SR);
   if(select)
     val |= (uint16_t)1<<6;
   else val &= ~((uint16_t)1<<6);
-  return writeReg(OMIXER_SR, val);
+  return writeRouting(OMIXER_SR, val);
 }
 
 bool AC101Codec::omixerRightLineRight(bool select)
 {
-  uint16_t val = readReg(OMIXER_SR);
+  uint16_t val = readRouting(OMIXER_SR);
   if(select)
     val |= (uint16_t)1<<10;
   else val &= ~((uint16_t)1<<10);
-  return writeReg(OMIXER_SR, val);
+  return writeRouting(OMIXER_SR, val);
 }
 
 bool AC101Codec::omixerRightDacRight(bool select)
 {
-  uint16_t val = readReg(OMIXER_SR);
+  uint16_t val = readRouting(OMIXER_SR);
   if(select)
     val |= (uint16_t)1<<8;
   else val &= ~((uint16_t)1<<8);
-  return writeReg(OMIXER_SR, val);
+  return writeRouting(OMIXER_SR, val);
 }
 
 bool AC101Codec::omixerRightMic1(bool select)
 {
-  uint16_t val = readReg(OMIXER_SR);
+  uint16_t val = readRouting(OMIXER_SR);
   if(select)
     val |= (uint16_t)1<<13;
   else val &= ~((uint16_t)1<<13);
-  return writeReg(OMIXER_SR, val);
+  return writeRouting(OMIXER_SR, val);
 }
 
 bool AC101Codec::leftMic1(bool select)
 {
-	uint16_t val = readReg(ADC_SRC);
+	uint16_t val = readRouting(ADC_SRC);
 	if(select)
 		val |= (uint16_t)1<<LEFT_MIC1_ENABIT;
 	else val &= ~((uint16_t)1<<LEFT_MIC1_ENABIT);
-	return writeReg(ADC_SRC, val);
+	return writeRouting(ADC_SRC, val);
 }
  
 bool AC101Codec::rightMic1(bool select)
 {
-	uint16_t val = readReg(ADC_SRC);
+	uint16_t val = readRouting(ADC_SRC);
 	if(select)
 		val |= (uint16_t)1<<RIGHT_MIC1_ENABIT;
 	else val &= ~((uint16_t)1<<RIGHT_MIC1_ENABIT);
-	return writeReg(ADC_SRC, val);
+	return writeRouting(ADC_SRC, val);
 }
 
 bool AC101Codec::leftLineLeft(bool select)
 {
-	uint16_t val = readReg(ADC_SRC);
+	uint16_t val = readRouting(ADC_SRC);
 	if(select)
 		val |= (uint16_t)1<<LEFT_LINELEFT_ENABIT;
 	else val &= ~((uint16_t)1<<LEFT_LINELEFT_ENABIT);
-	return writeReg(ADC_SRC, val);
+	return writeRouting(ADC_SRC, val);
 }
 
 bool AC101Codec::rightLineRight(bool select)
 {
-	uint16_t val = readReg(ADC_SRC);
+	uint16_t val = readRouting(ADC_SRC);
 	if(select)
 		val |= (uint16_t)1<<RIGHT_LINERIGHT_ENABIT;
 	else val &= ~((uint16_t)1<<RIGHT_LINERIGHT_ENABIT);
-	return writeReg(ADC_SRC, val);
+	return writeRouting(ADC_SRC, val);
 }
 
 bool AC101Codec::leftLineDiff(bool select)
 {
-	uint16_t val = readReg(ADC_SRC);
+	uint16_t val = readRouting(ADC_SRC);
 	if(select)
 		val |= (uint16_t)1<<LEFT_LINEDIFF_ENABIT;
 	else val &= ~((uint16_t)1<<LEFT_LINEDIFF_ENABIT);
-	return writeReg(ADC_SRC, val);
+	return writeRouting(ADC_SRC, val);
 }
 
 bool AC101Codec::rightLineDiff(bool select)
 {
-	uint16_t val = readReg(ADC_SRC);
+	uint16_t val = readRouting(ADC_SRC);
 	if(select)
 		val |= (uint16_t)1<<RIGHT_LINEDIFF_ENABIT;
 	else val &= ~((uint16_t)1<<RIGHT_LINEDIFF_ENABIT);
-	return writeReg(ADC_SRC, val);
+	return writeRouting(ADC_SRC, val);
 }
 
 
 bool AC101Codec::init(int address)
 {
 	outCorrectionGain = 1;
+	tunerRoute = TR_OFF;
 	i2cAddress = address;
 	bool ok = true;
 	ok &= writeReg(CHIP_AUDIO_RS, 0x123);
@@ -562,6 +581,44 @@ bool AC101Codec::analogSoftBypass(bool bypass, BYPASS_MODE bm)
     return true;
 }
 
+//write the module's routing with the tuner override
+bool AC101Codec::applyTunerRouting()
+{
+	uint16_t adcSrc = moduleAdcSrc;
+	uint16_t omixer = moduleOmixer;
+	if(tunerRoute != TR_OFF)
+	{
+		//the pitch detector reads the left adc, the module's input stays muted if its routing disconnects it
+		*muteLeftAdcIn = !(moduleAdcSrc & ((uint16_t)1<<LEFT_LINELEFT_ENABIT));
+		adcSrc |= (uint16_t)1<<LEFT_LINELEFT_ENABIT;
+		if(tunerRoute == TR_MUTE)
+			omixer = 0;
+		else if(tunerRoute == TR_BYPASS)
+		{
+			//dac left and right, line left, line right (IM_LR) or mic1 (IM_LMIC) to the right
+			omixer = ((uint16_t)1<<1) | ((uint16_t)1<<8) | ((uint16_t)1<<3);
+			omixer |= (getInputMode() == 0) ? ((uint16_t)1<<10) : ((uint16_t)1<<13);
+		}
+	}
+	else *muteLeftAdcIn = false;
+	bool ok = writeReg(ADC_SRC, adcSrc);
+	ok &= writeReg(OMIXER_SR, omixer);
+	return ok;
+}
+
+bool AC101Codec::tunerRouting(TUNER_ROUTING routing)
+{
+	if(tunerRoute == TR_OFF)
+	{
+		if(routing == TR_OFF)
+			return true;
+		moduleAdcSrc = readReg(ADC_SRC);
+		moduleOmixer = readReg(OMIXER_SR);
+	}
+	tunerRoute = routing;
+	return applyTunerRouting();
+}
+
 ////////////////////////////////////////////////////////////////////////
 //ES8388 codec class
 bool ES8388Codec::writeReg(uint8_t reg, uint16_t val)
@@ -591,6 +648,7 @@ bool ES8388Codec::init(int address)
 {
 	outCorrectionGain = 1.05924; //correction for -0.5 missmatch of always-on ALC gain
 	i2cAddress = address;
+	tunerRoute = TR_OFF;
 	bool res = true;
 
     //INITIALIZATION (BASED ON ES8388 USER GUIDE EXAMPLE)
@@ -698,8 +756,8 @@ bool ES8388Codec::init(int address)
 	
 	//Setup Mixer, Please refer to Mixer description
 	res &= writeReg(ES8388_DACCONTROL16,0x1B); //left in select for out mix: L-ADC-IN, Right in select for outmix: R-ADC-IN
-	res &= writeReg(ES8388_DACCONTROL17,0x90); //left mixer input from left dac only, gain = 0dB
-	res &= writeReg(ES8388_DACCONTROL20,0x90); //right mixer input from right dac only, gain = 0dB
+	res &= writeMixer(ES8388_DACCONTROL17,0x90); //left mixer input from left dac only, gain = 0dB
+	res &= writeMixer(ES8388_DACCONTROL20,0x90); //right mixer input from right dac only, gain = 0dB
 	
 	//Set LOUT/ROUT Volume
 	res &= writeReg(ES8388_DACCONTROL24,0x1E);// L1 (0dB)
@@ -830,9 +888,9 @@ bool ES8388Codec::analogBypass(bool bypass, BYPASS_MODE bm)
 			*muteRightAdcIn= true;
 		
 		if((bm==BM_LR)||(bm==BM_L))
-			res &= writeReg(ES8388_DACCONTROL17,0x50); //disable ldac, enable lin, gain = 0dB
+			res &= writeMixer(ES8388_DACCONTROL17,0x50); //disable ldac, enable lin, gain = 0dB
 		if((bm==BM_LR)||(bm==BM_R))
-			res &= writeReg(ES8388_DACCONTROL20,0x50); //disable rdac, enable rin, gain = 0dB
+			res &= writeMixer(ES8388_DACCONTROL20,0x50); //disable rdac, enable rin, gain = 0dB
 	}
 	else
 	{
@@ -842,9 +900,9 @@ bool ES8388Codec::analogBypass(bool bypass, BYPASS_MODE bm)
 			*muteRightAdcIn= false;
 		
 		if((bm==BM_LR)||(bm==BM_L))
-			res &= writeReg(ES8388_DACCONTROL17,0x90); //enable ldac,disable lin, gain = 0dB
+			res &= writeMixer(ES8388_DACCONTROL17,0x90); //enable ldac,disable lin, gain = 0dB
 		if((bm==BM_LR)||(bm==BM_R))
-			res &= writeReg(ES8388_DACCONTROL20,0x90); //enable rdac,disable rin, gain = 0dB
+			res &= writeMixer(ES8388_DACCONTROL20,0x90); //enable rdac,disable rin, gain = 0dB
 	}	
 	return res;
 }
@@ -861,9 +919,9 @@ bool ES8388Codec::analogSoftBypass(bool bypass, BYPASS_MODE bm)
 			*muteRightAdcIn= true;
 		
 		if((bm==BM_LR)||(bm==BM_L))
-			res &= writeReg(ES8388_DACCONTROL17,0xD0); //enable ldac, enable lin, gain = 0dB
+			res &= writeMixer(ES8388_DACCONTROL17,0xD0); //enable ldac, enable lin, gain = 0dB
 		if((bm==BM_LR)||(bm==BM_R))
-			res &= writeReg(ES8388_DACCONTROL20,0xD0); //enable rdac, enable rin, gain = 0dB
+			res &= writeMixer(ES8388_DACCONTROL20,0xD0); //enable rdac, enable rin, gain = 0dB
 	}
 	else
 	{
@@ -873,10 +931,49 @@ bool ES8388Codec::analogSoftBypass(bool bypass, BYPASS_MODE bm)
 			*muteRightAdcIn= false;
 		
 		if((bm==BM_LR)||(bm==BM_L))
-			res &= writeReg(ES8388_DACCONTROL17,0x90); //enable ldac,disable lin, gain = 0dB
+			res &= writeMixer(ES8388_DACCONTROL17,0x90); //enable ldac,disable lin, gain = 0dB
 		if((bm==BM_LR)||(bm==BM_R))
-			res &= writeReg(ES8388_DACCONTROL20,0x90); //enable rdac,disable rin, gain = 0dB
+			res &= writeMixer(ES8388_DACCONTROL20,0x90); //enable rdac,disable rin, gain = 0dB
+	}
+	return res;
+}
+
+//the output mixers keep the module's selection while the tuner overrides the routing
+bool ES8388Codec::writeMixer(uint8_t reg, uint16_t val)
+{
+	if(reg == ES8388_DACCONTROL17)
+		moduleMixerLeft = val;
+	else moduleMixerRight = val;
+	if(tunerRoute == TR_OFF)
+		return writeReg(reg, val);
+	return applyTunerRouting();
+}
+
+//write the module's routing with the tuner override,
+//the adc stays connected (the bypass mutes the module's input in the frame processor, after the tuner tap)
+bool ES8388Codec::applyTunerRouting()
+{
+	uint16_t left = moduleMixerLeft;
+	uint16_t right = moduleMixerRight;
+	if(tunerRoute == TR_MUTE)
+	{
+		left = 0x10; //disable ldac, disable lin, gain = 0dB
+		right = 0x10;
 	}
+	else if(tunerRoute == TR_BYPASS)
+	{
+		left = 0xD0; //enable ldac, enable lin, gain = 0dB
+		right = 0xD0;
+	}
+	bool res = writeReg(ES8388_DACCONTROL17, left);
+	res &= writeReg(ES8388_DACCONTROL20, right);
 	return res;
 }
 
+bool ES8388Codec::tunerRouting(TUNER_ROUTING routing)
+{
+	if((routing == TR_OFF) && (tunerRoute == TR_OFF))
+		return true;
+	tunerRoute = routing;
+	return applyTunerRouting();
+}
@@ -17,6 +17,14 @@ typedef enum
 	BM_R  	//bypass R channel only
 } BYPASS_MODE;
 
+typedef enum
+{
+	TR_OFF,		//the module's routing (default)
+	TR_MUTE,	//no output
+	TR_BYPASS,	//the analog input and the dac to the output
+	TR_THROUGH	//the module's output routing
+} TUNER_ROUTING;
+
 //function to init the i2c bus at specific pins and clock frequency
 bool codecBusInit(int sdaPin, int sclPin, int frequency);
 
@@ -75,6 +83,10 @@ class codec
 
 	//bypassed the analog input to the output, disconnect the digital input, preserve the digital output connection
 	virtual bool analogSoftBypass(bool bypass, BYPASS_MODE bm=BM_LR){return 0;};  
+	
+	//override the output routing while the tuner is active, the left adc input stays connected for the pitch detector,
+	//the bypass calls of the module are kept and take effect again with TR_OFF
+	virtual bool tunerRouting(TUNER_ROUTING routing){return 0;};
 };
 
 //class for AC101 codec
@@ -90,6 +102,14 @@ class AC101Codec:public codec
 	bool setI2sSampleRate(uint16_t rate);
 	bool setI2sClock(uint16_t bitClockDiv, uint16_t bitClockInv, uint16_t lrClockDiv, uint16_t lrClockInv);
 	
+	//the input and output mixer selection, kept as the module's routing while the tuner overrides it
+	TUNER_ROUTING tunerRoute;
+	uint16_t moduleAdcSrc;
+	uint16_t moduleOmixer;
+	uint16_t readRouting(uint8_t reg);
+	bool writeRouting(uint8_t reg, uint16_t val);
+	bool applyTunerRouting();
+	
 	//leftchannel input selector methods
 	bool leftMic1(bool select);		//left channel mic1 select
 	bool leftLineDiff(bool select);	//left channel line difference (line Left- Line Right)
@@ -135,6 +155,8 @@ class AC101Codec:public codec
 
 	//bypassed the analog input to the output, disconnect the digital input, preserve the digital output connection
 	bool analogSoftBypass(bool bypass, BYPASS_MODE bm=BM_LR);  
+	
+	bool tunerRouting(TUNER_ROUTING routing);
 };
 
 //class for ES8388 codec
@@ -144,6 +166,13 @@ class ES8388Codec:public codec
 	bool writeReg(uint8_t reg, uint16_t val);
 	uint16_t readReg(uint8_t reg);
 	
+	//the output mixer selection, kept as the module's routing while the tuner overrides it
+	TUNER_ROUTING tunerRoute;
+	uint16_t moduleMixerLeft;
+	uint16_t moduleMixerRight;
+	bool writeMixer(uint8_t reg, uint16_t val);
+	bool applyTunerRouting();
+	
 	public:
 	//initialize the codec
 	bool init(int address);
@@ -172,6 +201,8 @@ class ES8388Codec:public codec
 
 	//bypassed the analog input to the output, disconnect the digital input, preserve the digital output connection
 	bool analogSoftBypass(bool bypass, BYPASS_MODE bm=BM_LR);  
+	
+	bool tunerRouting(TUNER_ROUTING routing);
 };
 
 #endif
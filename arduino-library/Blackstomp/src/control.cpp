@@ -36,21 +36,6 @@ void controltask(void *arg)
     vTaskDelay(1);
     con->runningTicks++;
     
-    if(con->runningTicks < 200) //stabilize the filter and skip the routine
-    {
-      for(int i=0;i<6;i++)
-      {
-        float val = analogRead(con->controlPin[i]);
-        if(con->module->control[i].inverted)
-          val = 4095-val;
-        if(con->module->control[i].slowSpeed)
-			con->slowLpf[i]->process((const float*)&val, &val, 1);
-		else 
-			con->lpf[i]->process((const float*)&val, &val, 1);
-      }
-      continue; //skip the routine
-    }
-    
     for(int i=0;i<6;i++)
     {
       //read the analog port
@@ -300,28 +285,16 @@ controlInterface::controlInterface()
   {
     controlState[i]=0;
 
-    //fourth order filter setup 10 Hz cut off at 1k samples/s
+    //fourth order butterworth, 10 Hz cut off at 1k samples/s
+    float coefficients[10];
     lpf[i] = new biquadFilter(2);
-    //set the coefficients for 10 Hz cut off frequency at 1k sample/s
-    const float coefficients[] = 
-    {
-      //these coefficients are calculated using online digital filter design tool https://www.micromodeler.com/dsp/
-      //10 Hz
-      0.0009200498139105926, 0.0018400996278211852, 0.0009200498139105926, 1.8866095826215064, -0.8903397362840242, // b0, b1, b2, a1, a2
-      0.0009765625, 0.001953125, 0.0009765625, 1.9492159580258417, -0.9530698953278909 //  b0, b1, b2, a1, a2
-    };
+    designButterworth(coefficients, 2, false, 10, 1000);
     lpf[i]->setCoef(coefficients);
     
-    //fourth order filter setup 4 Hz cut off at 1k samples/s
+    //fourth order butterworth, 4 Hz cut off at 1k samples/s
     slowLpf[i] = new biquadFilter(2);
-    const float coefficients2[] = 
-    {
-      //these coefficients are calculated using online digital filter design tool https://www.micromodeler.com/dsp/    
-      //4 Hz
-		0.00019772393992324234, 0.0003954478798464847, 0.00019772393992324234, 1.954001961679803, -0.9546192513864591,// b0, b1, b2, a1, a2
-		0.0001220703125, 0.000244140625, 0.0001220703125, 1.980323859118934, -0.9809494641889661// b0, b1, b2, a1, a2
-    };
-    slowLpf[i]->setCoef(coefficients2);
+    designButterworth(coefficients, 2, false, 4, 1000);
+    slowLpf[i]->setCoef(coefficients);
   }  
 }
 
@@ -334,7 +307,7 @@ controlInterface::~controlInterface()
   }
 }
 
-void controlInterface::init(int p1pin, int p2pin, int p3pin, int p4pin, int p5pin, int p6pin, int priority)
+void controlInterface::init(int p1pin, int p2pin, int p3pin, int p4pin, int p5pin, int p6pin)
 {
   controlPin[0]=p1pin;
   controlPin[1]=p2pin;
@@ -342,5 +315,30 @@ void controlInterface::init(int p1pin, int p2pin, int p3pin, int p4pin, int p5pi
   controlPin[3]=p4pin;
   controlPin[4]=p5pin;
   controlPin[5]=p6pin;
+  
+  for(int i=0;i<6;i++)
+  {
+    float val = analogRead(controlPin[i]);
+    if(module->control[i].inverted)
+      val = 4095-val;
+      
+    //start the filters settled on the current reading instead of ramping up from zero
+    lpf[i]->reset(val);
+    slowLpf[i]->reset(val);
+    
+    //initial position of the potentiometers and selectors
+    if((module->control[i].mode == CM_POT)||(module->control[i].mode == CM_SELECTOR))
+    {
+      int position = val/(4096/module->control[i].levelCount);
+      if(position >= module->control[i].levelCount)
+        position = module->control[i].levelCount -1;
+      if(position < 0) position = 0;
+      module->control[i].value = position;
+    }
+  }
+}
+
+void controlInterface::start(int priority)
+{
   xTaskCreatePinnedToCore(controltask, "controltask",4096,(void*)this,priority,NULL,0);
 }
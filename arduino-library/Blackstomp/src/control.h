@@ -34,7 +34,10 @@
 class controlInterface
 {
   public:
-    void init(int p1pin, int p2pin, int p3pin, int p4pin, int p5pin, int p6pin, int priority);
+    //read the current control positions and settle the filters on them (no callback is called)
+    void init(int p1pin, int p2pin, int p3pin, int p4pin, int p5pin, int p6pin);
+    //start the control task, which calls the module's onControlChange() on every change
+    void start(int priority);
     effectModule* module;
     unsigned int runningTicks;
     bool unsavedchanges;
@@ -1,524 +1,10 @@
 #ifndef DSPTABLE_H_
 #define DSPTABLE_H_
 
-const float sin_table[] =
-{
-  0.00000000  ,
-  0.02463745  ,
-  0.04925994  ,
-  0.07385253  ,
-  0.09840028  ,
-  0.12288829  ,
-  0.14730170  ,
-  0.17162568  ,
-  0.19584547  ,
-  0.21994636  ,
-  0.24391372  ,
-  0.26773300  ,
-  0.29138975  ,
-  0.31486959  ,
-  0.33815827  ,
-  0.36124167  ,
-  0.38410575  ,
-  0.40673664  ,
-  0.42912061  ,
-  0.45124406  ,
-  0.47309356  ,
-  0.49465584  ,
-  0.51591783  ,
-  0.53686660  ,
-  0.55748944  ,
-  0.57777383  ,
-  0.59770746  ,
-  0.61727822  ,
-  0.63647424  ,
-  0.65528385  ,
-  0.67369564  ,
-  0.69169844  ,
-  0.70928131  ,
-  0.72643357  ,
-  0.74314483  ,
-  0.75940492  ,
-  0.77520398  ,
-  0.79053241  ,
-  0.80538092  ,
-  0.81974048  ,
-  0.83360239  ,
-  0.84695821  ,
-  0.85979985  ,
-  0.87211951  ,
-  0.88390971  ,
-  0.89516329  ,
-  0.90587342  ,
-  0.91603360  ,
-  0.92563766  ,
-  0.93467977  ,
-  0.94315443  ,
-  0.95105652  ,
-  0.95838122  ,
-  0.96512409  ,
-  0.97128103  ,
-  0.97684832  ,
-  0.98182256  ,
-  0.98620075  ,
-  0.98998021  ,
-  0.99315867  ,
-  0.99573418  ,
-  0.99770518  ,
-  0.99907048  ,
-  0.99982925  ,
-  0.99998103  ,
-  0.99952572  ,
-  0.99846360  ,
-  0.99679532  ,
-  0.99452190  ,
-  0.99164470  ,
-  0.98816547  ,
-  0.98408634  ,
-  0.97940977  ,
-  0.97413860  ,
-  0.96827604  ,
-  0.96182564  ,
-  0.95479132  ,
-  0.94717736  ,
-  0.93898836  ,
-  0.93022931  ,
-  0.92090552  ,
-  0.91102265  ,
-  0.90058670  ,
-  0.88960401  ,
-  0.87808125  ,
-  0.86602540  ,
-  0.85344380  ,
-  0.84034407  ,
-  0.82673417  ,
-  0.81262237  ,
-  0.79801723  ,
-  0.78292761  ,
-  0.76736268  ,
-  0.75133189  ,
-  0.73484497  ,
-  0.71791192  ,
-  0.70054304  ,
-  0.68274886  ,
-  0.66454018  ,
-  0.64592806  ,
-  0.62692381  ,
-  0.60753895  ,
-  0.58778525  ,
-  0.56767472  ,
-  0.54721955  ,
-  0.52643216  ,
-  0.50532518  ,
-  0.48391142  ,
-  0.46220388  ,
-  0.44021574  ,
-  0.41796034  ,
-  0.39545121  ,
-  0.37270199  ,
-  0.34972651  ,
-  0.32653871  ,
-  0.30315267  ,
-  0.27958259  ,
-  0.25584278  ,
-  0.23194764  ,
-  0.20791169  ,
-  0.18374952  ,
-  0.15947579  ,
-  0.13510525  ,
-  0.11065268  ,
-  0.08613294  ,
-  0.06156091  ,
-  0.03695150  ,
-  0.01231966  ,
-  -0.01231966 ,
-  -0.03695150 ,
-  -0.06156091 ,
-  -0.08613294 ,
-  -0.11065268 ,
-  -0.13510525 ,
-  -0.15947579 ,
-  -0.18374952 ,
-  -0.20791169 ,
-  -0.23194764 ,
-  -0.25584278 ,
-  -0.27958259 ,
-  -0.30315267 ,
-  -0.32653871 ,
-  -0.34972651 ,
-  -0.37270199 ,
-  -0.39545121 ,
-  -0.41796034 ,
-  -0.44021574 ,
-  -0.46220388 ,
-  -0.48391142 ,
-  -0.50532518 ,
-  -0.52643216 ,
-  -0.54721955 ,
-  -0.56767472 ,
-  -0.58778525 ,
-  -0.60753895 ,
-  -0.62692381 ,
-  -0.64592806 ,
-  -0.66454018 ,
-  -0.68274886 ,
-  -0.70054304 ,
-  -0.71791192 ,
-  -0.73484497 ,
-  -0.75133189 ,
-  -0.76736268 ,
-  -0.78292761 ,
-  -0.79801723 ,
-  -0.81262237 ,
-  -0.82673417 ,
-  -0.84034407 ,
-  -0.85344380 ,
-  -0.86602540 ,
-  -0.87808125 ,
-  -0.88960401 ,
-  -0.90058670 ,
-  -0.91102265 ,
-  -0.92090552 ,
-  -0.93022931 ,
-  -0.93898836 ,
-  -0.94717736 ,
-  -0.95479132 ,
-  -0.96182564 ,
-  -0.96827604 ,
-  -0.97413860 ,
-  -0.97940977 ,
-  -0.98408634 ,
-  -0.98816547 ,
-  -0.99164470 ,
-  -0.99452190 ,
-  -0.99679532 ,
-  -0.99846360 ,
-  -0.99952572 ,
-  -0.99998103 ,
-  -0.99982925 ,
-  -0.99907048 ,
-  -0.99770518 ,
-  -0.99573418 ,
-  -0.99315867 ,
-  -0.98998021 ,
-  -0.98620075 ,
-  -0.98182256 ,
-  -0.97684832 ,
-  -0.97128103 ,
-  -0.96512409 ,
-  -0.95838122 ,
-  -0.95105652 ,
-  -0.94315443 ,
-  -0.93467977 ,
-  -0.92563766 ,
-  -0.91603360 ,
-  -0.90587342 ,
-  -0.89516329 ,
-  -0.88390971 ,
-  -0.87211951 ,
-  -0.85979985 ,
-  -0.84695821 ,
-  -0.83360239 ,
-  -0.81974048 ,
-  -0.80538092 ,
-  -0.79053241 ,
-  -0.77520398 ,
-  -0.75940492 ,
-  -0.74314483 ,
-  -0.72643357 ,
-  -0.70928131 ,
-  -0.69169844 ,
-  -0.67369564 ,
-  -0.65528385 ,
-  -0.63647424 ,
-  -0.61727822 ,
-  -0.59770746 ,
-  -0.57777383 ,
-  -0.55748944 ,
-  -0.53686660 ,
-  -0.51591783 ,
-  -0.49465584 ,
-  -0.47309356 ,
-  -0.45124406 ,
-  -0.42912061 ,
-  -0.40673664 ,
-  -0.38410575 ,
-  -0.36124167 ,
-  -0.33815827 ,
-  -0.31486959 ,
-  -0.29138975 ,
-  -0.26773300 ,
-  -0.24391372 ,
-  -0.21994636 ,
-  -0.19584547 ,
-  -0.17162568 ,
-  -0.14730170 ,
-  -0.12288829 ,
-  -0.09840028 ,
-  -0.07385253 ,
-  -0.04925994 ,
-  -0.02463745 ,
-  0.00000000
-};
+#include "lookuptable.h"
 
-const float hann_table[] =
-{
-	0.00000000	,
-	0.00015177	,
-	0.00060700	,
-	0.00136541	,
-	0.00242654	,
-	0.00378975	,
-	0.00545420	,
-	0.00741888	,
-	0.00968261	,
-	0.01224402	,
-	0.01510153	,
-	0.01825343	,
-	0.02169779	,
-	0.02543253	,
-	0.02945537	,
-	0.03376389	,
-	0.03835545	,
-	0.04322727	,
-	0.04837640	,
-	0.05379971	,
-	0.05949390	,
-	0.06545553	,
-	0.07168096	,
-	0.07816643	,
-	0.08490798	,
-	0.09190154	,
-	0.09914286	,
-	0.10662753	,
-	0.11435102	,
-	0.12230863	,
-	0.13049554	,
-	0.13890677	,
-	0.14753723	,
-	0.15638166	,
-	0.16543470	,
-	0.17469085	,
-	0.18414450	,
-	0.19378990	,
-	0.20362120	,
-	0.21363243	,
-	0.22381751	,
-	0.23417027	,
-	0.24468440	,
-	0.25535354	,
-	0.26617120	,
-	0.27713082	,
-	0.28822574	,
-	0.29944923	,
-	0.31079447	,
-	0.32225458	,
-	0.33382260	,
-	0.34549150	,
-	0.35725421	,
-	0.36910357	,
-	0.38103240	,
-	0.39303346	,
-	0.40509945	,
-	0.41722306	,
-	0.42939692	,
-	0.44161365	,
-	0.45386582	,
-	0.46614600	,
-	0.47844673	,
-	0.49076055	,
-	0.50307997	,
-	0.51539753	,
-	0.52770574	,
-	0.53999713	,
-	0.55226423	,
-	0.56449961	,
-	0.57669583	,
-	0.58884548	,
-	0.60094120	,
-	0.61297564	,
-	0.62494149	,
-	0.63683150	,
-	0.64863843	,
-	0.66035512	,
-	0.67197446	,
-	0.68348940	,
-	0.69489294	,
-	0.70617816	,
-	0.71733821	,
-	0.72836632	,
-	0.73925578	,
-	0.75000000	,
-	0.76059244	,
-	0.77102668	,
-	0.78129638	,
-	0.79139530	,
-	0.80131732	,
-	0.81105641	,
-	0.82060666	,
-	0.82996227	,
-	0.83911756	,
-	0.84806697	,
-	0.85680508	,
-	0.86532657	,
-	0.87362627	,
-	0.88169914	,
-	0.88954029	,
-	0.89714494	,
-	0.90450850	,
-	0.91162647	,
-	0.91849455	,
-	0.92510857	,
-	0.93146450	,
-	0.93755849	,
-	0.94338684	,
-	0.94894602	,
-	0.95423264	,
-	0.95924349	,
-	0.96397554	,
-	0.96842592	,
-	0.97259191	,
-	0.97647100	,
-	0.98006082	,
-	0.98335920	,
-	0.98636414	,
-	0.98907380	,
-	0.99148655	,
-	0.99360092	,
-	0.99541563	,
-	0.99692957	,
-	0.99814183	,
-	0.99905166	,
-	0.99965853	,
-	0.99996206	,
-	0.99996206	,
-	0.99965853	,
-	0.99905166	,
-	0.99814183	,
-	0.99692957	,
-	0.99541563	,
-	0.99360092	,
-	0.99148655	,
-	0.98907380	,
-	0.98636414	,
-	0.98335920	,
-	0.98006082	,
-	0.97647100	,
-	0.97259191	,
-	0.96842592	,
-	0.96397554	,
-	0.95924349	,
-	0.95423264	,
-	0.94894602	,
-	0.94338684	,
-	0.93755849	,
-	0.93146450	,
-	0.92510857	,
-	0.91849455	,
-	0.91162647	,
-	0.90450850	,
-	0.89714494	,
-	0.88954029	,
-	0.88169914	,
-	0.87362627	,
-	0.86532657	,
-	0.85680508	,
-	0.84806697	,
-	0.83911756	,
-	0.82996227	,
-	0.82060666	,
-	0.81105641	,
-	0.80131732	,
-	0.79139530	,
-	0.78129638	,
-	0.77102668	,
-	0.76059244	,
-	0.75000000	,
-	0.73925578	,
-	0.72836632	,
-	0.71733821	,
-	0.70617816	,
-	0.69489294	,
-	0.68348940	,
-	0.67197446	,
-	0.66035512	,
-	0.64863843	,
-	0.63683150	,
-	0.62494149	,
-	0.61297564	,
-	0.60094120	,
-	0.58884548	,
-	0.57669583	,
-	0.56449961	,
-	0.55226423	,
-	0.53999713	,
-	0.52770574	,
-	0.51539753	,
-	0.50307997	,
-	0.49076055	,
-	0.47844673	,
-	0.46614600	,
-	0.45386582	,
-	0.44161365	,
-	0.42939692	,
-	0.41722306	,
-	0.40509945	,
-	0.39303346	,
-	0.38103240	,
-	0.36910357	,
-	0.35725421	,
-	0.34549150	,
-	0.33382260	,
-	0.32225458	,
-	0.31079447	,
-	0.29944923	,
-	0.28822574	,
-	0.27713082	,
-	0.26617120	,
-	0.25535354	,
-	0.24468440	,
-	0.23417027	,
-	0.22381751	,
-	0.21363243	,
-	0.20362120	,
-	0.19378990	,
-	0.18414450	,
-	0.17469085	,
-	0.16543470	,
-	0.15638166	,
-	0.14753723	,
-	0.13890677	,
-	0.13049554	,
-	0.12230863	,
-	0.11435102	,
-	0.10662753	,
-	0.09914286	,
-	0.09190154	,
-	0.08490798	,
-	0.07816643	,
-	0.07168096	,
-	0.06545553	,
-	0.05949390	,
-	0.05379971	,
-	0.04837640	,
-	0.04322727	,
-	0.03835545	,
-	0.03376389	,
-	0.02945537	,
-	0.02543253	,
-	0.02169779	,
-	0.01825343	,
-	0.01510153	,
-	0.01224402	,
-	0.00968261	,
-	0.00741888	,
-	0.00545420	,
-	0.00378975	,
-	0.00242654	,
-	0.00136541	,
-	0.00060700	,
-	0.00015177	,
-	0.00000000	
-};
+//one cycle over 0 .. 255 (256 points, table[255] == table[0]), generated at compile time
+static const float (&sin_table)[256] = sharedTable<sineShape, float, 255>::table.data;
+static const float (&hann_table)[256] = sharedTable<hannShape, float, 255>::table.data;
 
 #endif
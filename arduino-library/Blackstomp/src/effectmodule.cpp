@@ -33,6 +33,9 @@
    
    inputMode = IM_LR;
    encoderMode = EM_DISABLED;
+   processMode = PM_SEPARATE;
+   pipelined = false;
+   parameters = NULL;
    
    bleTerminal.servUuid = "d11747ac-6172-4bb1-9b3a-20d58cc88f20";
    bleTerminal.charUuid = "7a9fd763-04a5-4a17-b625-1fce28329f23";
@@ -63,3 +66,21 @@ effectModule::~effectModule()
 {
   deInit();
 }
+
+void effectModule::process(float* inLeft, float* inRight, float* outLeft, float* outRight, int sampleCount)
+{
+  for(int i=0;i<sampleCount;i++)
+  {
+    outLeft[i] = inLeft[i];
+    outRight[i] = inRight[i];
+  }
+}
+
+void effectModule::processStage0(float* inLeft, float* inRight, float* outLeft, float* outRight, int sampleCount)
+{
+  for(int i=0;i<sampleCount;i++)
+  {
+    outLeft[i] = inLeft[i];
+    outRight[i] = inRight[i];
+  }
+}
@@ -29,6 +29,7 @@
 #define EFFECTMODULE_H_
 
 #include <Arduino.h>
+#include <atomic>
 #include "ledindicator.h"
 
 typedef enum
@@ -58,6 +59,15 @@ typedef enum
 } 
 CONTROL_MODE;
 
+typedef enum
+{
+  PM_SEPARATE,    //process(): separate input and output float buffers per channel (default)
+  PM_INPLACE,     //processInPlace(): float buffers per channel, the output overwrites the input
+  PM_INTERLEAVED, //processInterleaved(): one interleaved float frame (L,R,L,R,..), processed in place
+  PM_RAW          //processRaw(): the i2s frame itself, interleaved 24-bit samples left-justified in 32-bit integers
+}
+PROCESS_MODE;
+
 typedef enum
 {
   BM_DISABLED,
@@ -95,6 +105,86 @@ struct BLETERMINAL
 	uint32_t passKey;
 };
 
+//PARAMETER BLOCK
+//parameter set shared between the control callbacks (core 0) and process() (core 1)
+//the callbacks take the working copy with lock(), modify it and publish it with commit() (which releases the lock),
+//the lock is held from lock() to commit(), so a callback of another task never publishes a half-edited set,
+//the audio task takes the latest committed set at the block boundary with a single atomic swap,
+//so process() always reads a consistent set through get() during the whole block,
+//in pipelined mode processStage0() (core 0) has its own copy of the sets, read through getStage0()
+//derived values (e.g. filter coefficients) should be computed in the callbacks and stored in the set
+class parameterBlockBase
+{
+  public:
+  //called by the audio task at the block boundary, before process()
+  virtual void acquire()=0;
+  //called by the core-0 stage task at its block boundary, before processStage0()
+  virtual void acquireStage0()=0;
+};
+
+template <class T> class parameterBlock: public parameterBlockBase
+{
+  private:
+    //one triple buffer per reader: front (reader), back (writer) and the published slot
+    struct channel
+    {
+      T slots[3];
+      int front;            //slot index used by the reader
+      int back;             //slot index used by the writer
+      std::atomic<int> published; //published slot index | FRESH
+      enum {FRESH = 4};
+      channel(){front = 0; back = 1; published = 2;}
+      void publish(const T& set)
+      {
+        slots[back] = set;
+        back = published.exchange(back | FRESH) & 3;
+      }
+      void acquire()
+      {
+        if(published.load() & FRESH)
+          front = published.exchange(front) & 3;
+      }
+    };
+    T edits;              //writer's working copy
+    channel audio;        //process() on core 1
+    channel stage0;       //processStage0() on core 0 (pipelined mode)
+    std::atomic_flag editing;   //the callbacks run in several core-0 tasks
+    
+  public:
+    parameterBlock()
+    {
+      editing.clear();
+    }
+    
+    //writer side (control callbacks): lock() and modify the working copy, then publish it with commit(),
+    //every lock() must be followed by one commit() in the same callback, don't call lock() twice
+    T& lock()
+    {
+      while(editing.test_and_set(std::memory_order_acquire))
+      {
+#ifdef ARDUINO_ARCH_ESP32
+        //let the holder (possibly a lower priority task on the same core) finish its edit
+        vTaskDelay(1);
+#endif
+      }
+      return edits;
+    }
+    void commit()
+    {
+      audio.publish(edits);
+      stage0.publish(edits);
+      editing.clear(std::memory_order_release);
+    }
+    
+    //reader side (process()): the set taken at the last block boundary
+    const T& get(){return audio.slots[audio.front];}
+    void acquire(){audio.acquire();}
+    
+    //reader side of the core-0 stage (processStage0()): the set taken at its last block boundary
+    const T& getStage0(){return stage0.slots[stage0.front];}
+    void acquireStage0(){stage0.acquire();}
+};
+
 class effectModule
 {
   public:
@@ -106,6 +196,16 @@ class effectModule
   BLETERMINAL bleTerminal; 
   ledIndicator* mainLed;
   ledIndicator* auxLed;
+  
+  //processing entry point called by the audio task, set in init() to skip the conversions the module doesn't need
+  //(always PM_SEPARATE in pipelined mode)
+  PROCESS_MODE processMode;
+  
+  //set to true in init() to split the processing across both cores (see processStage0())
+  bool pipelined;
+  
+  //optional parameter block, assign it in init() to let the audio task acquire it at every block boundary
+  parameterBlockBase* parameters;
 
   //base class constructor, do basic initialization, don't write a constructor in your descendant class
   effectModule();
@@ -126,8 +226,28 @@ class effectModule
   virtual void onButtonRelease(int buttonIndex){};
   virtual void onBleTerminalRequest(const char* request, char* response){};
 
-  //you have to always overload with your own process() function in your descendant class
-  virtual void process(float* inLeft, float* inRight, float* outLeft, float* outRight, int sampleCount)=0;
+  //you have to overload with your own process() function in your descendant class,
+  //or with the processing function selected by processMode,
+  //declare it with override so that a mistyped signature fails to compile,
+  //the default implementation passes the input through (like the other processing functions)
+  virtual void process(float* inLeft, float* inRight, float* outLeft, float* outRight, int sampleCount);
+  
+  //PM_INPLACE: the samples are processed in the input buffers
+  virtual void processInPlace(float* left, float* right, int sampleCount){};
+  
+  //PM_INTERLEAVED: the samples (2 x sampleCount, L,R,L,R,..) are processed in place
+  virtual void processInterleaved(float* frame, int sampleCount){};
+  
+  //PM_RAW: the i2s frame (2 x sampleCount, L,R,L,R,..) is processed in place, no float conversion at all,
+  //the samples are 24-bit left-justified (the lower 8 bits are zero), the module has to saturate its results,
+  //the codec's output level correction is not applied
+  virtual void processRaw(int32_t* frame, int sampleCount){};
+
+  //pipelined mode only: overload processStage0() with the first part of the processing, it runs on core 0
+  //and its output becomes the input of process() on core 1 one block later (one block of added latency),
+  //it reads the parameter block through getStage0(), never get() (that set belongs to process() on core 1)
+  //the default implementation passes the input through
+  virtual void processStage0(float* inLeft, float* inRight, float* outLeft, float* outRight, int sampleCount);
 
 };
 
@@ -0,0 +1,417 @@
+/*!
+ *  @file       frameprocessor.cpp
+ *  Project     Blackstomp Arduino Library
+ *  @brief      Blackstomp Library for the Arduino
+ *  @author     Hasan Murod
+ *  @date       17/10/2026
+ *  @license    MIT - Copyright (c) 2020 Hasan Murod
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+  
+#include "frameprocessor.h"
+
+//######################################################################
+// FRAME QUEUE
+frameQueue::frameQueue()
+{
+  buffer = NULL;
+  framelength = 0;
+  capacity = 0;
+  head = 0;
+  tail = 0;
+}
+
+frameQueue::~frameQueue()
+{
+  if(buffer != NULL)
+    delete[] buffer;
+}
+
+bool frameQueue::init(int sampleCount, int frameCount)
+{
+  if(buffer != NULL)
+    delete[] buffer;
+  
+  //round up the capacity to power of two for index masking
+  capacity = 1;
+  while(capacity < (unsigned int)frameCount)
+    capacity <<= 1;
+  
+  framelength = 2*sampleCount;
+  buffer = new float[capacity * framelength];
+  if(buffer == NULL)
+    return false;
+  for(unsigned int i=0;i<capacity * framelength;i++)
+    buffer[i] = 0;
+  head = 0;
+  tail = 0;
+  return true;
+}
+
+int frameQueue::count()
+{
+  return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire);
+}
+
+float* frameQueue::writeFrame()
+{
+  unsigned int h = head.load(std::memory_order_relaxed);
+  if(h - tail.load(std::memory_order_acquire) >= capacity)
+    return NULL;
+  return buffer + (h & (capacity-1)) * framelength;
+}
+
+void frameQueue::push()
+{
+  head.store(head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+float* frameQueue::readFrame()
+{
+  unsigned int t = tail.load(std::memory_order_relaxed);
+  if(head.load(std::memory_order_acquire) == t)
+    return NULL;
+  return buffer + (t & (capacity-1)) * framelength;
+}
+
+void frameQueue::pop()
+{
+  tail.store(tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+//######################################################################
+// FRAME PROCESSOR
+
+frameProcessor::frameProcessor()
+{
+  samplecount = 0;
+  inleft = NULL;
+  inright = NULL;
+  outleft = NULL;
+  outright = NULL;
+  module = NULL;
+  outCorrectionGain = 1;
+  muteLeftAdcIn = false;
+  muteRightAdcIn = false;
+  silent = false;
+  pipelined = false;
+  fadeLength = 0;
+  fadePosition = 0;
+  stage0Misses = 0;
+  onStage0Request = NULL;
+}
+
+frameProcessor::~frameProcessor()
+{
+  if(inleft != NULL)
+    delete[] inleft;
+}
+
+bool frameProcessor::init(int sampleCount)
+{
+  if(inleft != NULL)
+    delete[] inleft;
+  
+  //single allocation for the 4 channel buffers
+  samplecount = sampleCount;
+  inleft = new float[4*samplecount];
+  if(inleft == NULL)
+    return false;
+  inright = inleft + samplecount;
+  outleft = inright + samplecount;
+  outright = outleft + samplecount;
+  
+  for(int i=0;i<4*samplecount;i++)
+    inleft[i] = 0;
+  return true;
+}
+
+int frameProcessor::getSampleCount()
+{
+  return samplecount;
+}
+
+bool frameProcessor::initPipeline()
+{
+  //4 frames of room on each side, only one frame is in flight in normal operation
+  if(!stage0In.init(samplecount, 4) || !stage0Out.init(samplecount, 4))
+    return false;
+    
+  //prime the output side with a silent frame, that is the one block of pipeline latency
+  stage0Out.writeFrame();
+  stage0Out.push();
+  pipelined = true;
+  return true;
+}
+
+bool frameProcessor::isPipelined()
+{
+  return pipelined;
+}
+
+bool frameProcessor::processStage0()
+{
+  float* in = stage0In.readFrame();
+  if(in == NULL)
+    return false;
+  
+  float* out = stage0Out.writeFrame();
+  if(out != NULL)
+  {
+    //the core-0 stage takes the latest parameter set from its own slots
+    if(module->parameters != NULL)
+      module->parameters->acquireStage0();
+    module->processStage0(in, in + samplecount, out, out + samplecount, samplecount);
+    stage0Out.push();
+  }
+  stage0In.pop();
+  return true;
+}
+
+void frameProcessor::fadeIn(int fadeSamples)
+{
+  fadePosition = 0;
+  fadeLength = fadeSamples;
+  silent = false;
+}
+
+//PM_INTERLEAVED: single conversion pass without deinterleaving, the frame is processed in place
+void frameProcessor::processInterleaved(const int32_t* inbuffer, int32_t* outbuffer)
+{
+  //the channel buffers are contiguous, inleft holds the whole interleaved frame
+  float* frame = inleft;
+  int framelength = 2*samplecount;
+  
+  if(silent)
+  {
+    for(int i=0;i<framelength;i++)
+      frame[i] = 0;
+  }
+  else
+  {
+    //convert to 24 bit int then to float scaled to 1.0
+    for(int i=0;i<framelength;i++)
+      frame[i] = (float)(inbuffer[i]>>8)/8388608;
+    if(muteLeftAdcIn)
+      for(int i=0;i<framelength;i+=2) frame[i] = 0;
+    if(muteRightAdcIn)
+      for(int i=1;i<framelength;i+=2) frame[i] = 0;
+      
+    //ramp the input up after the silence
+    if(fadePosition < fadeLength)
+    {
+      float step = 1.0f/(float)fadeLength;
+      for(int i=0;(i<framelength)&&(fadePosition<fadeLength);i+=2,fadePosition++)
+      {
+        float g = step * (float)fadePosition;
+        frame[i] = g * frame[i];
+        frame[i+1] = g * frame[i+1];
+      }
+    }
+  }
+  
+  module->processInterleaved(frame, samplecount);
+  
+  //convert back float to int, saturated to signed 24bit range
+  for(int i=0;i<framelength;i++)
+  {
+    float val = outCorrectionGain * frame[i] * 8388607;
+    if(val>8388607) val=8388607;
+    if(val<-8388607) val= -8388607;
+    outbuffer[i] = ((int32_t) val)<<8;
+  }
+}
+
+//PM_RAW: no conversion, the module processes the i2s frame
+void frameProcessor::processRaw(const int32_t* inbuffer, int32_t* outbuffer)
+{
+  int framelength = 2*samplecount;
+  
+  if(silent)
+  {
+    for(int i=0;i<framelength;i++)
+      outbuffer[i] = 0;
+  }
+  else
+  {
+    //keep the 24-bit data only
+    for(int i=0;i<framelength;i++)
+      outbuffer[i] = inbuffer[i] & 0xFFFFFF00;
+    if(muteLeftAdcIn)
+      for(int i=0;i<framelength;i+=2) outbuffer[i] = 0;
+    if(muteRightAdcIn)
+      for(int i=1;i<framelength;i+=2) outbuffer[i] = 0;
+      
+    //ramp the input up after the silence
+    if(fadePosition < fadeLength)
+    {
+      float step = 1.0f/(float)fadeLength;
+      for(int i=0;(i<framelength)&&(fadePosition<fadeLength);i+=2,fadePosition++)
+      {
+        float g = step * (float)fadePosition;
+        outbuffer[i] = ((int32_t)(g * (float)(outbuffer[i]>>8)))<<8;
+        outbuffer[i+1] = ((int32_t)(g * (float)(outbuffer[i+1]>>8)))<<8;
+      }
+    }
+  }
+  
+  module->processRaw(outbuffer, samplecount);
+}
+
+void frameProcessor::process(const int32_t* inbuffer, int32_t* outbuffer)
+{
+  //the lighter entry points of the module skip the channel buffers (not in pipelined mode)
+  if(!pipelined && (module->processMode >= PM_INTERLEAVED))
+  {
+    //take the latest parameter set committed by the control callbacks
+    if(module->parameters != NULL)
+      module->parameters->acquire();
+    if(module->processMode == PM_INTERLEAVED)
+      processInterleaved(inbuffer, outbuffer);
+    else processRaw(inbuffer, outbuffer);
+    return;
+  }
+  
+  float* inl = inleft;
+  float* inr = inright;
+  float* stageout = NULL;
+  float* stagein = NULL;
+  
+  if(pipelined)
+  {
+    //keep exactly one block in flight, drop the older ones after a late core-0 stage
+    while(stage0Out.count() > 1)
+      stage0Out.pop();
+    stageout = stage0Out.readFrame();
+    
+    //convert the input directly into the core-0 stage queue
+    stagein = stage0In.writeFrame();
+    if(stagein != NULL)
+    {
+      inl = stagein;
+      inr = stagein + samplecount;
+    }
+  }
+  
+  if(silent)
+  {
+    for(int k=0;k<samplecount;k++)
+    {
+      inl[k] = 0;  
+      inr[k] = 0;
+    }
+  }
+  else 
+  for(int i=0,k=0;k<samplecount;k++,i+=2)
+  {
+    if(!muteLeftAdcIn)
+    {
+      //convert to 24 bit int then to float
+      inl[k] = (float) (inbuffer[i]>>8);
+      //scale to 1.0
+      inl[k] = inl[k]/8388608;
+    }
+    else inl[k]=0;
+    
+    if(!muteRightAdcIn)
+    {
+      //convert to 24 bit int then to float
+      inr[k] = (float) (inbuffer[i+1]>>8);
+      //scale to 1.0
+      inr[k]=inr[k]/8388608;
+    }
+    else inr[k] = 0;
+  }
+  
+  //ramp the input up after the silence
+  if(!silent && (fadePosition < fadeLength))
+  {
+    float step = 1.0f/(float)fadeLength;
+    for(int k=0;(k<samplecount)&&(fadePosition<fadeLength);k++,fadePosition++)
+    {
+      float g = step * (float)fadePosition;
+      inl[k] = g * inl[k];
+      inr[k] = g * inr[k];
+    }
+  }
+
+  //take the latest parameter set committed by the control callbacks
+  if(module->parameters != NULL)
+    module->parameters->acquire();
+
+  float* outl = outleft;
+  float* outr = outright;
+  if(!pipelined)
+  {
+    //process the signal by the effect module
+    if(module->processMode == PM_INPLACE)
+    {
+      module->processInPlace(inleft, inright, samplecount);
+      outl = inleft;
+      outr = inright;
+    }
+    else module->process(inleft, inright, outleft, outright, samplecount);
+  }
+  else
+  {
+    //hand over the new frame to the core-0 stage
+    if(stagein != NULL)
+    {
+      stage0In.push();
+      if(onStage0Request != NULL)
+        onStage0Request();
+    }
+    else stage0Misses++;
+    
+    //process the core-0 stage output of the previous block
+    if(stageout != NULL)
+    {
+      module->process(stageout, stageout + samplecount, outleft, outright, samplecount);
+      stage0Out.pop();
+    }
+    else
+    {
+      stage0Misses++;
+      for(int k=0;k<samplecount;k++)
+      {
+        outleft[k] = 0;
+        outright[k] = 0;
+      }
+    }
+  }
+  
+  //convert back float to int
+  for(int i=0,k=0;k<samplecount;k++,i+=2)
+  {
+    //scale the left output to 24 bit range
+    outl[k] = outCorrectionGain * outl[k] * 8388607;
+    //saturate to signed 24bit range
+    if(outl[k]>8388607) outl[k]=8388607;
+    if(outl[k]<-8388607) outl[k]= -8388607;
+
+    //scale the right output to 24 bit range
+    outr[k]=outCorrectionGain * outr[k] * 8388607;
+    //saturate to signed 24bit range
+    if(outr[k]>8388607) outr[k]=8388607;
+    if(outr[k]<-8388607) outr[k]= -8388607;
+    outbuffer[i] = ((int32_t) outl[k])<<8;
+    outbuffer[i+1] = ((int32_t) outr[k])<<8;
+  }
+}
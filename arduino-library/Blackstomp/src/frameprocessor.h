@@ -0,0 +1,112 @@
+/*!
+ *  @file       frameprocessor.h
+ *  Project     Blackstomp Arduino Library
+ *  @brief      Blackstomp Library for the Arduino
+ *  @author     Hasan Murod
+ *  @date       17/10/2026
+ *  @license    MIT - Copyright (c) 2020 Hasan Murod
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef FRAMEPROCESSOR_H_
+#define FRAMEPROCESSOR_H_
+
+#include <atomic>
+#include "effectmodule.h"
+
+//lock-free single-producer single-consumer queue of stereo float frames (L block followed by R block)
+//used to pass the audio blocks between the two cores in pipelined mode
+class frameQueue
+{
+  private:
+    float* buffer;
+    int framelength;
+    unsigned int capacity;            //power of two
+    std::atomic<unsigned int> head;   //written by the producer only
+    std::atomic<unsigned int> tail;   //written by the consumer only
+    
+  public:
+    frameQueue();
+    ~frameQueue();
+    bool init(int sampleCount, int frameCount);
+    int count();
+    
+    //producer side: get the free frame to fill (NULL when full), then push it
+    float* writeFrame();
+    void push();
+    
+    //consumer side: get the oldest frame (NULL when empty), then pop it
+    float* readFrame();
+    void pop();
+};
+
+//frame processor converts the interleaved i2s frame (L,R,L,R,..) of 32-bit samples
+//into separate float channel buffers, runs the effect module's process(),
+//then converts the result back into the i2s frame
+//it is shared by the i2s_task() and the host offline renderer (extras/hostrender)
+class frameProcessor
+{
+  private:
+    int samplecount;
+    float* inleft;
+    float* inright;
+    float* outleft;
+    float* outright;
+    bool pipelined;
+    int fadeLength;         //input fade-in length in samples
+    int fadePosition;       //input fade-in progress in samples
+    frameQueue stage0In;    //input frames for the core-0 stage
+    frameQueue stage0Out;   //core-0 stage output frames for process()
+    void processInterleaved(const int32_t* inbuffer, int32_t* outbuffer);
+    void processRaw(const int32_t* inbuffer, int32_t* outbuffer);
+    
+  public:
+    effectModule* module;
+    float outCorrectionGain;  //codec's output level correction
+    bool muteLeftAdcIn;       //set by the codec in analog bypass mode
+    bool muteRightAdcIn;      //set by the codec in analog bypass mode
+    bool silent;              //silence the whole input (e.g. during startup)
+    unsigned int stage0Misses;  //blocks where the core-0 stage output was not ready (pipelined mode)
+    void (*onStage0Request)(void);  //called when a new frame is queued for the core-0 stage
+    
+    frameProcessor();
+    ~frameProcessor();
+    
+    //allocate the channel buffers for sampleCount samples per channel
+    bool init(int sampleCount);
+    int getSampleCount();
+    
+    //enable the pipelined mode: the module's processStage0() runs on the other core through processStage0(),
+    //and its output is fed to the module's process() one block later (call after init())
+    bool initPipeline();
+    bool isPipelined();
+    
+    //end the silence with a linear fade-in of the input over fadeSamples samples (e.g. after startup)
+    void fadeIn(int fadeSamples);
+    
+    //process one frame of (2 x sampleCount) interleaved samples
+    void process(const int32_t* inbuffer, int32_t* outbuffer);
+    
+    //run the module's processStage0() on one queued frame (pipelined mode)
+    //returns false when no frame is waiting
+    bool processStage0();
+};
+
+#endif
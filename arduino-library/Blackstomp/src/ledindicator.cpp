@@ -143,6 +143,10 @@ void ledIndicator::init(int pin, int priority)
   terminaterequest = 0;
   runstate = 1;
   missedCount = 0;
+  blinkstate = blinkstate_turnedoff;
+  savedstate = blinkstate_turnedoff;
+  for(int i=0;i<5;i++)
+    savedperiods[i] = 1;
   xSemaphore = xSemaphoreCreateBinary();
   if(xSemaphore!=0)
     xSemaphoreGive(xSemaphore);
@@ -214,6 +218,46 @@ void ledIndicator::turnOn()
   }
 }
 
+void ledIndicator::saveState()
+{
+  if(xSemaphoreTake(xSemaphore,(TickType_t)1) == pdTRUE)
+  {
+    if((blinkstate == blinkstate_turnedoff) || (blinkstate == blinkstate_turnedon))
+      savedstate = blinkstate;
+    else savedstate = blinkstate_start;
+    savedperiods[0] = onperiod;
+    savedperiods[1] = offperiod;
+    savedperiods[2] = restperiod;
+    savedperiods[3] = blinks;
+    savedperiods[4] = repeat;
+    xSemaphoreGive(xSemaphore);
+  }
+  else
+  {
+    missedCount ++;
+  }
+}
+
+void ledIndicator::restoreState()
+{
+  if(xSemaphoreTake(xSemaphore,(TickType_t)1) == pdTRUE)
+  {
+    onperiod = savedperiods[0];
+    offperiod = savedperiods[1];
+    restperiod = savedperiods[2];
+    blinks = savedperiods[3];
+    repeat = savedperiods[4];
+    repeatcount = 0;
+    blinkcount = 0;
+    blinkstate = savedstate;
+    xSemaphoreGive(xSemaphore);
+  }
+  else
+  {
+    missedCount ++;
+  }
+}
+
 void ledIndicator::turnOff()
 {
   if(xSemaphoreTake(xSemaphore,(TickType_t)1) == pdTRUE)
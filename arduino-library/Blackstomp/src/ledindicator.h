@@ -35,6 +35,9 @@ class ledIndicator
   void turnOff();
   void blink(int onPeriod, int offPeriod,int blinkCount,int repeatCount,int restPeriod);
   void blinkUpdate(int onPeriod, int offPeriod,int blinkCount,int repeatCount,int restPeriod);
+  //keep the current state while the led is borrowed (e.g. by the tuner) and bring it back, a blink restarts
+  void saveState();
+  void restoreState();
   void init(int pin, int priority);
   void deInit();
   unsigned int missedCount; //missing tick by sync wait
@@ -54,6 +57,8 @@ class ledIndicator
   int runstate;
   int terminaterequest;
   int blinkstate;
+  int savedstate;
+  int savedperiods[5]; //on, off, rest, blinks, repeat
   SemaphoreHandle_t xSemaphore;
   friend void blinktask(void* arg);
 };
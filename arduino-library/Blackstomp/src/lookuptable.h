@@ -0,0 +1,236 @@
+/*!
+ *  @file       lookuptable.h
+ *  Project     Blackstomp Arduino Library
+ *  @brief      Blackstomp Library for the Arduino
+ *  @author     Hasan Murod
+ *  @date       17/10/2026
+ *  @license    MIT - Copyright (c) 2020 Hasan Murod
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef LOOKUPTABLE_H_
+#define LOOKUPTABLE_H_
+
+#include <stdint.h>
+
+//COMPILE-TIME LOOKUP TABLES
+//the tables are computed by the compiler (no startup cost) and shared by every user of the same
+//shape, storage type and size, a table of SIZE intervals has SIZE+1 points: the last one is the
+//guard point (the value at x = 1.0) so the interpolation never wraps or tests the end
+//
+//  //shared instance, in flash (.rodata) on the esp32
+//  const tableData<float, 1024>& sine = sharedTable<sineShape, float, 1024>::table;
+//  float y = tableLookupPhase(sine, phase32);
+//
+//  //own instance, e.g. in DRAM for the fastest access
+//  DRAM_ATTR static const tableData<int16_t, 512> tanhQ15 = makeTable<tanhShape<3>, int16_t, 512>();
+//
+//the shapes map x = 0 .. 1.0 to the table value, new shapes are structs with the same
+//static constexpr double value(double x) function
+
+//compile-time math in double (c++11 constexpr: single return statement, recursion)
+struct tableMath
+{
+  static constexpr double pi() { return 3.14159265358979323846; }
+  static constexpr double ln10() { return 2.30258509299404568402; }
+  static constexpr double floor(double x) { return ((double)(long long)x > x) ? (double)(long long)x - 1.0 : (double)(long long)x; }
+  static constexpr double abs(double x) { return (x < 0) ? -x : x; }
+  static constexpr double square(double x) { return x * x; }
+  
+  //taylor series of sin for -pi .. pi, terms up to x^29
+  static constexpr double sinSeries(double x2, double term, int n, double sum)
+  {
+    return (n > 29) ? sum : sinSeries(x2, -term * x2 / (double)((n + 1) * (n + 2)), n + 2, sum + term);
+  }
+  static constexpr double sinReduced(double x) { return sinSeries(x * x, x, 1, 0); }
+  static constexpr double sin(double x) { return sinReduced(x - 2.0 * pi() * floor((x + pi()) / (2.0 * pi()))); }
+  static constexpr double cos(double x) { return sin(x + 0.5 * pi()); }
+  
+  //exp(x) = exp(x/2)^2 down to |x| <= 0.5, then the taylor series
+  static constexpr double expSeries(double x, double term, int n, double sum)
+  {
+    return (n > 20) ? sum : expSeries(x, term * x / (double)(n + 1), n + 1, sum + term);
+  }
+  static constexpr double exp(double x) { return (abs(x) > 0.5) ? square(exp(0.5 * x)) : expSeries(x, 1.0, 0, 0); }
+  static constexpr double tanhPositive(double e) { return (1.0 - e) / (1.0 + e); }
+  static constexpr double tanh(double x) { return (x < 0) ? -tanhPositive(exp(2.0 * x)) : tanhPositive(exp(-2.0 * x)); }
+};
+
+//TABLE SHAPES (x = 0 .. 1.0)
+
+//one sine cycle
+struct sineShape
+{
+  static constexpr double value(double x) { return tableMath::sin(2.0 * tableMath::pi() * x); }
+};
+
+//hann window, 0 at both ends
+struct hannShape
+{
+  static constexpr double value(double x) { return 0.5 - 0.5 * tableMath::cos(2.0 * tableMath::pi() * x); }
+};
+
+//hamming window, 0.08 at both ends
+struct hammingShape
+{
+  static constexpr double value(double x) { return 0.54 - 0.46 * tableMath::cos(2.0 * tableMath::pi() * x); }
+};
+
+//4-term blackman-harris window (-92 dB side lobes), 0 at both ends
+struct blackmanHarrisShape
+{
+  static constexpr double value(double x)
+  {
+    return 0.35875 - 0.48829 * tableMath::cos(2.0 * tableMath::pi() * x) + 0.14128 * tableMath::cos(4.0 * tableMath::pi() * x) - 0.01168 * tableMath::cos(6.0 * tableMath::pi() * x);
+  }
+};
+
+//tanh(GAIN.u) for u = -1 .. 1 (the default waveShaper curve is GAIN = 3)
+template <int GAIN>
+struct tanhShape
+{
+  static constexpr double value(double x) { return tableMath::tanh((double)GAIN * (2.0 * x - 1.0)); }
+};
+
+//exp(RANGE.(x - 1)): e^-RANGE .. 1, e.g. exponential decay and attack curves
+template <int RANGE>
+struct expShape
+{
+  static constexpr double value(double x) { return tableMath::exp((double)RANGE * (x - 1.0)); }
+};
+
+//linear gain of MINDB .. MAXDB decibels
+template <int MINDB, int MAXDB>
+struct dbGainShape
+{
+  static constexpr double value(double x) { return tableMath::exp(((double)MINDB + (double)(MAXDB - MINDB) * x) * tableMath::ln10() / 20.0); }
+};
+
+//TABLE STORAGE
+//float, or int16_t in Q15 (-1.0 .. 1.0, half the memory, for shapes inside that range)
+template <typename T>
+struct tableStorage;
+
+template <>
+struct tableStorage<float>
+{
+  static constexpr float store(double v) { return (float)v; }
+  static constexpr float scale() { return 1.0f; }
+};
+
+template <>
+struct tableStorage<int16_t>
+{
+  static constexpr int16_t saturate(double v) { return (v >= 32767.0) ? 32767 : ((v <= -32768.0) ? -32768 : (int16_t)v); }
+  static constexpr int16_t store(double v) { return saturate((v < 0) ? v * 32768.0 - 0.5 : v * 32768.0 + 0.5); }
+  static constexpr float scale() { return 1.0f / 32768.0f; }
+};
+
+template <typename T, int SIZE>
+struct tableData
+{
+  T data[SIZE + 1];
+};
+
+//index sequence 0 .. N-1, built by halves to keep the template depth at log2(N)
+template <int... I>
+struct tableIndices {};
+
+template <class A, class B>
+struct joinTableIndices;
+
+template <int... A, int... B>
+struct joinTableIndices<tableIndices<A...>, tableIndices<B...> >
+{
+  typedef tableIndices<A..., (int)sizeof...(A) + B...> type;
+};
+
+template <int N>
+struct makeTableIndices
+{
+  typedef typename joinTableIndices<typename makeTableIndices<N / 2>::type, typename makeTableIndices<N - N / 2>::type>::type type;
+};
+
+template <>
+struct makeTableIndices<0>
+{
+  typedef tableIndices<> type;
+};
+
+template <>
+struct makeTableIndices<1>
+{
+  typedef tableIndices<0> type;
+};
+
+template <class SHAPE, typename T, int SIZE, int... I>
+constexpr tableData<T, SIZE> buildTable(tableIndices<I...>)
+{
+  return tableData<T, SIZE>{{ tableStorage<T>::store(SHAPE::value((double)I / (double)SIZE))... }};
+}
+
+//the table as a value, to initialize any constant (e.g. with DRAM_ATTR)
+template <class SHAPE, typename T, int SIZE>
+constexpr tableData<T, SIZE> makeTable()
+{
+  return buildTable<SHAPE, T, SIZE>(typename makeTableIndices<SIZE + 1>::type());
+}
+
+//one shared instance per shape, storage type and size
+template <class SHAPE, typename T, int SIZE>
+struct sharedTable
+{
+  static constexpr tableData<T, SIZE> table = makeTable<SHAPE, T, SIZE>();
+};
+
+template <class SHAPE, typename T, int SIZE>
+constexpr tableData<T, SIZE> sharedTable<SHAPE, T, SIZE>::table;
+
+//LOOKUP
+
+//linear interpolation at x = 0 .. 1.0 (clamped)
+template <typename T, int SIZE>
+inline float tableLookup(const tableData<T, SIZE>& t, float x)
+{
+  float pos = x * (float)SIZE;
+  if(pos < 0) pos = 0;
+  if(pos > (float)SIZE * 0.99999f) pos = (float)SIZE * 0.99999f;
+  int index = (int)pos;
+  float frac = pos - (float)index;
+  float y0 = (float)t.data[index];
+  return (y0 + frac * ((float)t.data[index + 1] - y0)) * tableStorage<T>::scale();
+}
+
+constexpr int tableLog2(int n) { return (n <= 1) ? 0 : 1 + tableLog2(n / 2); }
+
+//linear interpolation at a 32-bit phase (one cycle = 2^32) of a periodic table,
+//SIZE must be a power of two: the index is the top bits of the phase, the fraction the next ones
+template <typename T, int SIZE>
+inline float tableLookupPhase(const tableData<T, SIZE>& t, uint32_t phase)
+{
+  static_assert((SIZE & (SIZE - 1)) == 0, "tableLookupPhase needs a power of two table size");
+  const int bits = tableLog2(SIZE);
+  int index = (int)(phase >> (32 - bits));
+  float frac = (float)((phase << bits) >> 8) * (1.0f / 16777216.0f);
+  float y0 = (float)t.data[index];
+  return (y0 + frac * ((float)t.data[index + 1] - y0)) * tableStorage<T>::scale();
+}
+
+#endif
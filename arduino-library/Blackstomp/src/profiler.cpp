@@ -0,0 +1,108 @@
+/*!
+ *  @file       profiler.cpp
+ *  Project     Blackstomp Arduino Library
+ *  @brief      Blackstomp Library for the Arduino
+ *  @author     Hasan Murod
+ *  @date       17/10/2026
+ *  @license    MIT - Copyright (c) 2020 Hasan Murod
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "profiler.h"
+
+static PROFILESTAGE profileTable[PROFILE_MAXSTAGES];
+static int profileStageCount = 0;
+
+static void clearStage(PROFILESTAGE* s)
+{
+  s->calls = 0;
+  s->ticks = 0;
+  s->samples = 0;
+  s->minTicks = 0xFFFFFFFF;
+  s->maxTicks = 0;
+}
+
+int profileRegister(const char* name)
+{
+  //the same name may be used by several markers
+  for(int i=0;i<profileStageCount;i++)
+  {
+    if(!strcmp(profileTable[i].name, name))
+      return i;
+  }
+  if(profileStageCount >= PROFILE_MAXSTAGES)
+    return -1;
+  
+  PROFILESTAGE* s = &profileTable[profileStageCount];
+  clearStage(s);
+  s->name = name;
+  return profileStageCount++;
+}
+
+void profileAdd(int stage, unsigned int ticks, int sampleCount)
+{
+  if((stage < 0) || (sampleCount < 1))
+    return;
+  PROFILESTAGE* s = &profileTable[stage];
+  unsigned int perSample = ticks / sampleCount;
+  s->calls++;
+  s->ticks += ticks;
+  s->samples += sampleCount;
+  if(perSample < s->minTicks)
+    s->minTicks = perSample;
+  if(perSample > s->maxTicks)
+    s->maxTicks = perSample;
+}
+
+int getProfileStageCount()
+{
+  return profileStageCount;
+}
+
+const PROFILESTAGE* getProfileStage(int stage)
+{
+  if((stage < 0) || (stage >= profileStageCount))
+    return NULL;
+  return &profileTable[stage];
+}
+
+int getProfileReport(char* buffer, int bufferSize)
+{
+  int len = 0;
+  buffer[0] = 0;
+  for(int i=0;(i<profileStageCount) && (len < bufferSize);i++)
+  {
+    PROFILESTAGE* s = &profileTable[i];
+    if(s->samples == 0)
+      continue;
+    float mean = (float)s->ticks / (float)s->samples;
+    len += snprintf(buffer + len, bufferSize - len, "%s: min %u, mean %.1f, max %u ticks/sample\n",
+      s->name, s->minTicks, mean, s->maxTicks);
+  }
+  if(len >= bufferSize)
+    len = bufferSize - 1;
+  return len;
+}
+
+void resetProfile()
+{
+  for(int i=0;i<profileStageCount;i++)
+    clearStage(&profileTable[i]);
+}
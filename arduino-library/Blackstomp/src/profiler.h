@@ -0,0 +1,104 @@
+/*!
+ *  @file       profiler.h
+ *  Project     Blackstomp Arduino Library
+ *  @brief      Blackstomp Library for the Arduino
+ *  @author     Hasan Murod
+ *  @date       17/10/2026
+ *  @license    MIT - Copyright (c) 2020 Hasan Murod
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef PROFILER_H_
+#define PROFILER_H_
+
+#include <Arduino.h>
+
+//STAGE PROFILER
+//measures the cpu ticks of named processing stages, e.g. inside process():
+//
+//  PROFILE_STAGE("waveShaper", sampleCount);
+//  dist.process(buffer, buffer, sampleCount);
+//
+//the measurement lasts until the end of the enclosing scope { }, the result is accumulated
+//as min/mean/max ticks per sample per stage name into a fixed table (no allocation),
+//shown by runSystemMonitor() and readable as text by getProfileReport() (e.g. for the BLE terminal)
+//the markers compile to nothing unless BLACKSTOMP_PROFILER is defined before including blackstomp.h
+
+//maximum number of stage names in the table
+#define PROFILE_MAXSTAGES 16
+
+struct PROFILESTAGE
+{
+  const char* name;
+  unsigned int calls;
+  uint64_t ticks;       //total ticks
+  uint64_t samples;     //total samples
+  unsigned int minTicks;  //min ticks per sample
+  unsigned int maxTicks;  //max ticks per sample
+};
+
+//register a stage name, return its index in the table (-1 if the table is full)
+int profileRegister(const char* name);
+
+//add a measurement of a registered stage
+void profileAdd(int stage, unsigned int ticks, int sampleCount);
+
+//number of registered stages and the table access
+int getProfileStageCount();
+const PROFILESTAGE* getProfileStage(int stage);
+
+//format the table as text (one line per stage), return the string length
+int getProfileReport(char* buffer, int bufferSize);
+
+//clear the measurements (the names stay registered)
+void resetProfile();
+
+//scoped measurement, prefer the PROFILE_STAGE macro
+class profileScope
+{
+  private:
+    int stage;
+    int samples;
+    unsigned int start;
+  public:
+    profileScope(int stageIndex, int sampleCount)
+    {
+      stage = stageIndex;
+      samples = sampleCount;
+      start = xthal_get_ccount();
+    }
+    ~profileScope()
+    {
+      profileAdd(stage, xthal_get_ccount() - start, samples);
+    }
+};
+
+#define PROFILE_CONCAT2(a,b) a##b
+#define PROFILE_CONCAT(a,b) PROFILE_CONCAT2(a,b)
+
+#ifdef BLACKSTOMP_PROFILER
+#define PROFILE_STAGE(name, sampleCount) \
+  static int PROFILE_CONCAT(_profileStage,__LINE__) = profileRegister(name); \
+  profileScope PROFILE_CONCAT(_profileScope,__LINE__)(PROFILE_CONCAT(_profileStage,__LINE__), sampleCount)
+#else
+#define PROFILE_STAGE(name, sampleCount)
+#endif
+
+#endif